@@ -0,0 +1,373 @@
+// Throughput and allocation counts of big_integer operations over operand
+// sizes from 1 to 2^20 limbs, next to GMP's mpz_class when <gmpxx.h> is
+// available (define BIG_INTEGER_BENCH_NO_GMP to leave it out). Not part of
+// the test build; compile it on its own, e.g.
+//
+//   g++ -std=c++17 -O2 -DNDEBUG benchmarks.cpp big_integer.cpp
+//       digit_kernels.cpp limb_kernels.cpp thread_pool.cpp
+//       -lbenchmark -lgmpxx -lgmp -pthread -o benchmarks
+//   ./benchmarks --benchmark_filter='<big_integer, mul_op>'
+//
+// Division and decimal conversion are quadratic here, so their sweep stops
+// at 2^16 limbs.
+//
+// The mul_shape cases tune the multiplication tiers: balanced products in
+// steps of 8 limbs around the schoolbook/Karatsuba crossover, to be compared
+// across builds with -DBIG_INTEGER_KARATSUBA_THRESHOLD=16, 24, 48...; products
+// of n by r n limbs (r in percent), where the limb2 rate should stay flat
+// once r passes 200 and mul_unbalanced cuts a into pieces; and, on
+// a multi-core host, parallel products around the 1024-limb default of
+// set_parallel_mul(). The allocs counter is heap allocations per iteration,
+// operator new for big_integer and GMP's allocation hooks for mpz_class;
+// the per-thread scratch pool only shows up when it grows.
+
+#include "big_integer.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#if __has_include(<gmpxx.h>) && !defined(BIG_INTEGER_BENCH_NO_GMP)
+#include <gmpxx.h>
+#define BIG_INTEGER_BENCH_GMP
+#endif
+
+namespace {
+std::atomic<size_t> allocations{0};
+
+void* counted_alloc(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+// std::pmr::new_delete_resource(), where big_integer takes its limbs from by
+// default, goes through the aligned forms
+void* operator new(size_t size) {
+    if (void* p = counted_alloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) / alignment * alignment;
+    if (void* p = std::aligned_alloc(alignment, size == 0 ? alignment : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC takes the frees below for mismatched with its builtin operator new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#ifdef BIG_INTEGER_BENCH_GMP
+// GMP allocates through its own hooks rather than operator new
+namespace {
+void* gmp_realloc(void* p, size_t, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::realloc(p, size);
+}
+
+void gmp_free(void* p, size_t) {
+    std::free(p);
+}
+
+bool const gmp_counted =
+    (mp_set_memory_functions(counted_alloc, gmp_realloc, gmp_free), true);
+} // namespace
+#endif
+
+namespace {
+constexpr int64_t MIN_LIMBS = 1;
+constexpr int64_t LINEAR_MAX_LIMBS = int64_t(1) << 20;
+constexpr int64_t QUADRATIC_MAX_LIMBS = int64_t(1) << 16;
+constexpr int SHIFT = 1000;
+
+// random hexadecimal digits of exactly limbs limbs, so that both libraries
+// parse the same value in linear time
+std::string random_hex(size_t limbs, uint32_t seed) {
+    static char const digits[] = "0123456789abcdef";
+    std::mt19937 gen(seed);
+    std::string res(limbs * 8, '0');
+    for (char& c : res) {
+        c = digits[gen() % 16];
+    }
+    res[0] = digits[1 + gen() % 15];
+    return res;
+}
+
+template <typename T>
+T make_value(size_t limbs, uint32_t seed, bool negative = false);
+
+template <>
+big_integer make_value<big_integer>(size_t limbs, uint32_t seed,
+                                    bool negative) {
+    std::string hex = random_hex(limbs, seed);
+    big_integer res;
+    from_chars(hex.data(), hex.data() + hex.size(), res, 16);
+    return negative ? -res : res;
+}
+
+#ifdef BIG_INTEGER_BENCH_GMP
+template <>
+mpz_class make_value<mpz_class>(size_t limbs, uint32_t seed, bool negative) {
+    mpz_class res(random_hex(limbs, seed), 16);
+    return negative ? mpz_class(-res) : res;
+}
+#endif
+
+std::string decimal(big_integer const& a) {
+    return to_string(a);
+}
+
+#ifdef BIG_INTEGER_BENCH_GMP
+std::string decimal(mpz_class const& a) {
+    return a.get_str();
+}
+#endif
+
+struct add_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a + b;
+    }
+};
+
+struct sub_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a - b;
+    }
+};
+
+struct mul_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a * b;
+    }
+};
+
+struct and_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a & b;
+    }
+};
+
+struct or_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a | b;
+    }
+};
+
+struct xor_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a ^ b;
+    }
+};
+
+// divide 2n limbs by n limbs, the shape that does the most work
+struct div_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a / b;
+    }
+};
+
+struct mod_op {
+    template <typename T>
+    static T apply(T const& a, T const& b) {
+        return a % b;
+    }
+};
+
+void report(benchmark::State& state, size_t limbs, size_t allocated) {
+    int64_t iterations = state.iterations();
+    state.SetBytesProcessed(iterations * int64_t(limbs * sizeof(uint32_t)));
+    state.counters["allocs"] =
+        benchmark::Counter(double(allocated) / double(iterations));
+}
+
+template <typename T, typename Op>
+void bench_binary(benchmark::State& state) {
+    size_t n = state.range(0);
+    bool division = std::is_same_v<Op, div_op> || std::is_same_v<Op, mod_op>;
+    // the bitwise cases mix signs to go through the two's complement paths
+    bool bitwise = std::is_same_v<Op, and_op> || std::is_same_v<Op, or_op> ||
+                   std::is_same_v<Op, xor_op>;
+    T a = make_value<T>(division ? 2 * n : n, 1);
+    T b = make_value<T>(n, 2, bitwise);
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        T c = Op::apply(a, b);
+        benchmark::DoNotOptimize(c);
+    }
+    report(state, n, allocations.load(std::memory_order_relaxed) - before);
+}
+
+template <typename T>
+void bench_shl(benchmark::State& state) {
+    size_t n = state.range(0);
+    T a = make_value<T>(n, 1);
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        T c = a << SHIFT;
+        benchmark::DoNotOptimize(c);
+    }
+    report(state, n, allocations.load(std::memory_order_relaxed) - before);
+}
+
+template <typename T>
+void bench_shr(benchmark::State& state) {
+    size_t n = state.range(0);
+    T a = make_value<T>(n, 1, true);
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        T c = a >> SHIFT;
+        benchmark::DoNotOptimize(c);
+    }
+    report(state, n, allocations.load(std::memory_order_relaxed) - before);
+}
+
+template <typename T>
+void bench_to_string(benchmark::State& state) {
+    size_t n = state.range(0);
+    T a = make_value<T>(n, 1, true);
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        std::string s = decimal(a);
+        benchmark::DoNotOptimize(s);
+    }
+    report(state, n, allocations.load(std::memory_order_relaxed) - before);
+}
+
+template <typename T>
+void bench_from_string(benchmark::State& state) {
+    size_t n = state.range(0);
+    std::string str = decimal(make_value<T>(n, 1, true));
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        T a(str);
+        benchmark::DoNotOptimize(a);
+    }
+    report(state, n, allocations.load(std::memory_order_relaxed) - before);
+}
+
+// a of longer limbs times b of n limbs
+template <typename T>
+void run_mul(benchmark::State& state, size_t n, size_t longer) {
+    T a = make_value<T>(longer, 1);
+    T b = make_value<T>(n, 2);
+    size_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        T c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+    report(state, longer, allocations.load(std::memory_order_relaxed) - before);
+    // limb products per second for the schoolbook method, which stays flat
+    // over shapes that the same algorithm handles equally well
+    state.counters["limb2"] = benchmark::Counter(
+        double(n) * double(longer),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// n limbs times n * r / 100 limbs
+template <typename T>
+void bench_mul_shape(benchmark::State& state) {
+    size_t n = state.range(0);
+    run_mul<T>(state, n, n * state.range(1) / 100);
+}
+
+// n by n limbs on every core, split once n reaches min
+void bench_parallel_mul(benchmark::State& state) {
+    size_t n = state.range(0);
+    set_parallel_mul(std::thread::hardware_concurrency(), state.range(1));
+    run_mul<big_integer>(state, n, n);
+    set_parallel_mul(1);
+}
+
+void crossover_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"n", "r"});
+    for (int64_t n = 8; n <= 128; n += 8) {
+        b->Args({n, 100});
+    }
+}
+
+void unbalanced_shapes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"n", "r"});
+    for (int64_t n : {64, 512, 4096}) {
+        for (int64_t r : {100, 150, 199, 200, 300, 800}) {
+            b->Args({n, r});
+        }
+    }
+}
+
+void parallel_cutoffs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"n", "min"});
+    for (int64_t n : {256, 512, 1024, 2048, 4096}) {
+        b->Args({n, n});
+        b->Args({n, n + 1});
+    }
+}
+
+void linear_sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(8)->Range(MIN_LIMBS, LINEAR_MAX_LIMBS);
+}
+
+void quadratic_sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(8)->Range(MIN_LIMBS, QUADRATIC_MAX_LIMBS);
+}
+} // namespace
+
+#define BIG_INTEGER_BENCHMARKS(T)                                              \
+    BENCHMARK_TEMPLATE(bench_binary, T, add_op)->Apply(linear_sizes);          \
+    BENCHMARK_TEMPLATE(bench_binary, T, sub_op)->Apply(linear_sizes);          \
+    BENCHMARK_TEMPLATE(bench_binary, T, mul_op)->Apply(linear_sizes);          \
+    BENCHMARK_TEMPLATE(bench_binary, T, div_op)->Apply(quadratic_sizes);       \
+    BENCHMARK_TEMPLATE(bench_binary, T, mod_op)->Apply(quadratic_sizes);       \
+    BENCHMARK_TEMPLATE(bench_binary, T, and_op)->Apply(linear_sizes);          \
+    BENCHMARK_TEMPLATE(bench_binary, T, or_op)->Apply(linear_sizes);           \
+    BENCHMARK_TEMPLATE(bench_binary, T, xor_op)->Apply(linear_sizes);          \
+    BENCHMARK_TEMPLATE(bench_shl, T)->Apply(linear_sizes);                     \
+    BENCHMARK_TEMPLATE(bench_shr, T)->Apply(linear_sizes);                     \
+    BENCHMARK_TEMPLATE(bench_to_string, T)->Apply(quadratic_sizes);            \
+    BENCHMARK_TEMPLATE(bench_from_string, T)->Apply(quadratic_sizes);         \
+    BENCHMARK_TEMPLATE(bench_mul_shape, T)->Apply(crossover_sizes);            \
+    BENCHMARK_TEMPLATE(bench_mul_shape, T)->Apply(unbalanced_shapes)
+
+BIG_INTEGER_BENCHMARKS(big_integer);
+BENCHMARK(bench_parallel_mul)->Apply(parallel_cutoffs);
+#ifdef BIG_INTEGER_BENCH_GMP
+BIG_INTEGER_BENCHMARKS(mpz_class);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include "big_accumulator.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// every addition moves a slot by less than 2^32, so 2^30 of them can not
+// overflow a slot that started below 2^32
+constexpr uint32_t MAX_PENDING = 1u << 30;
+} // namespace
+
+big_accumulator::big_accumulator() = default;
+
+big_accumulator::big_accumulator(big_integer const& a) {
+    *this += a;
+}
+
+big_accumulator& big_accumulator::operator+=(big_integer const& rhs) {
+    add(rhs.number.get(), rhs.sign, false);
+    return *this;
+}
+
+big_accumulator& big_accumulator::operator-=(big_integer const& rhs) {
+    add(rhs.number.get(), rhs.sign, true);
+    return *this;
+}
+
+big_accumulator& big_accumulator::operator+=(big_accumulator const& rhs) {
+    big_accumulator other = rhs;
+    other.normalize();
+    normalize();
+    grow(other.slots.size());
+    for (size_t i = 0; i < other.slots.size(); i++) {
+        slots[i] += other.slots[i];
+    }
+    int64_t fill = other.sign != 0 ? UINT32_MAX : 0;
+    for (size_t i = other.slots.size(); i < slots.size(); i++) {
+        slots[i] += fill;
+    }
+    // two negative signs add up to -2, which grow() can not pad from
+    sign += other.sign;
+    normalize();
+    return *this;
+}
+
+big_integer big_accumulator::value() const {
+    big_accumulator cur = *this;
+    cur.normalize();
+    limb_vector number(cur.slots.begin(), cur.slots.end(),
+                       big_integer_resource());
+    return big_integer(std::move(number), cur.sign != 0 ? UINT32_MAX : 0);
+}
+
+void big_accumulator::add(limb_vector const& digits, uint32_t digits_sign,
+                          bool negate) {
+    if (pending == MAX_PENDING) {
+        normalize();
+    }
+    pending++;
+    grow(digits.size() + (digits_sign != 0 ? 1 : 0));
+    // a negative value is its digits minus 1 << 32 * digits.size()
+    if (negate) {
+        for (size_t i = 0; i < digits.size(); i++) {
+            slots[i] -= digits[i];
+        }
+    } else {
+        for (size_t i = 0; i < digits.size(); i++) {
+            slots[i] += digits[i];
+        }
+    }
+    if (digits_sign != 0) {
+        slots[digits.size()] += negate ? 1 : -1;
+    }
+}
+
+void big_accumulator::grow(size_t n) {
+    if (slots.size() < n) {
+        slots.resize(n, sign != 0 ? UINT32_MAX : 0);
+    }
+}
+
+void big_accumulator::normalize() {
+    int64_t carry = 0;
+    for (int64_t& slot : slots) {
+        int64_t cur = slot + carry;
+        slot = cur & UINT32_MAX;
+        carry = cur >> 32;
+    }
+    carry += sign;
+    while (carry != 0 && carry != -1) {
+        slots.push_back(carry & UINT32_MAX);
+        carry >>= 32;
+    }
+    sign = carry;
+    pending = 0;
+}
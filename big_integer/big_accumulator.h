@@ -0,0 +1,29 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstdint>
+#include <vector>
+
+// Running sum of big_integers. Digits are kept in 64-bit slots and additions
+// never propagate carries; they are resolved only when the value is read.
+struct big_accumulator {
+    big_accumulator();
+    explicit big_accumulator(big_integer const& a);
+
+    big_accumulator& operator+=(big_integer const& rhs);
+    big_accumulator& operator-=(big_integer const& rhs);
+    big_accumulator& operator+=(big_accumulator const& rhs);
+
+    big_integer value() const;
+
+private:
+    void add(limb_vector const& digits, uint32_t digits_sign, bool negate);
+    void grow(size_t n);
+    void normalize();
+
+private:
+    // value = sum(slots[i] << 32 * i) + (sign << 32 * slots.size())
+    int64_t sign{0};
+    std::vector<int64_t> slots;
+    uint32_t pending{0};
+};
@@ -1,15 +1,110 @@
 #include "big_integer.h"
+#include "digit_kernels.h"
+#include "limb_kernels.h"
+#include "thread_pool.h"
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
 #include <functional>
+#if defined(__SSE2__) || defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include <iostream>
+#include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <stdexcept>
 
 constexpr uint32_t CAPACITY = 32;
 constexpr uint32_t LOG_CAPACITY = 5;
+constexpr size_t DEFAULT_SCRATCH_LIMIT = size_t(4) << 20;
+constexpr size_t MAX_SCRATCH_BUFFERS = 16;
+
+namespace {
+// limb buffers of finished operations, kept for the next ones on this thread
+struct scratch_pool {
+    scratch_pool() {
+        buffers.reserve(MAX_SCRATCH_BUFFERS);
+    }
+
+    std::vector<limb_vector> buffers;
+    size_t retained{0};
+    size_t limit{DEFAULT_SCRATCH_LIMIT};
+
+    // drops buffers until at most `bytes` are retained
+    void shrink(size_t bytes) {
+        while (retained > bytes) {
+            retained -= buffers.back().capacity() * sizeof(uint32_t);
+            buffers.pop_back();
+        }
+    }
+};
+
+thread_local scratch_pool scratch_buffers;
+
+// empty limb buffer with room for at least n limbs, borrowed from the pool of
+// the calling thread for the lifetime of the scratch; fresh buffers round
+// their size up to a power of two, so a pool settles after a few calls
+struct scratch {
+    explicit scratch(size_t n) : buf(std::pmr::new_delete_resource()) {
+        scratch_pool& pool = scratch_buffers;
+        auto best = pool.buffers.end();
+        for (auto it = pool.buffers.begin(); it != pool.buffers.end(); ++it) {
+            if (it->capacity() >= n && (best == pool.buffers.end() ||
+                                        it->capacity() < best->capacity())) {
+                best = it;
+            }
+        }
+        if (best != pool.buffers.end()) {
+            buf = std::move(*best);
+            *best = std::move(pool.buffers.back());
+            pool.buffers.pop_back();
+            pool.retained -= buf.capacity() * sizeof(uint32_t);
+        } else if (n != 0) {
+            size_t cap = 1;
+            while (cap < n) {
+                cap <<= 1;
+            }
+            buf.reserve(cap);
+        }
+    }
+    scratch(scratch const& other) = delete;
+    scratch& operator=(scratch const& other) = delete;
+    ~scratch() {
+        scratch_pool& pool = scratch_buffers;
+        size_t bytes = buf.capacity() * sizeof(uint32_t);
+        // never reallocates buffers, which is reserved up front
+        if (bytes != 0 && pool.retained + bytes <= pool.limit &&
+            pool.buffers.size() < MAX_SCRATCH_BUFFERS) {
+            buf.clear();
+            pool.buffers.push_back(std::move(buf));
+            pool.retained += bytes;
+        }
+    }
+
+    limb_vector& operator*() {
+        return buf;
+    }
+    limb_vector* operator->() {
+        return &buf;
+    }
+
+    limb_vector buf;
+};
+} // namespace
+
+void set_scratch_limit(size_t bytes) {
+    scratch_buffers.limit = bytes;
+    scratch_buffers.shrink(bytes);
+}
+
+void trim_scratch() {
+    scratch_buffers.shrink(0);
+}
+
 bool big_integer::is_zero() const {
     return sign == 0 && number.empty();
 }
@@ -21,12 +116,73 @@ void big_integer::format_number() {
     }
 }
 
+big_integer_view::big_integer_view(big_integer const& a)
+    : digits(a.number.data()), size(a.number.size()), sign(a.sign) {}
+
+void big_integer::magnitude(big_integer_view v, limb_vector& out) {
+    out.assign(v.digits, v.digits + v.size);
+    if (v.sign != 0) {
+        out.push_back(v.sign);
+        uint64_t carry = 1;
+        for (uint32_t& digit : out) {
+            uint64_t sum = carry + (digit ^ UINT32_MAX);
+            digit = (sum & UINT32_MAX);
+            carry = (sum >> CAPACITY);
+        }
+    }
+    while (!out.empty() && out.back() == 0) {
+        out.pop_back();
+    }
+}
+
+// adds (or subtracts) the non-negative value digits[0, len)
+void big_integer::add_magnitude(uint32_t const* digits, size_t len,
+                                bool negative) {
+    size_t n = std::max(number.size(), len) + 2;
+    number.resize(n, sign);
+    uint32_t* d = number.data();
+    uint32_t flip = negative ? UINT32_MAX : 0;
+    uint64_t carry = negative ? 1 : 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t sum = carry + d[i] + ((i < len ? digits[i] : 0) ^ flip);
+        d[i] = (sum & UINT32_MAX);
+        carry = (sum >> CAPACITY);
+    }
+    sign = ((number.back() >> (CAPACITY - 1)) != 0 ? UINT32_MAX : 0);
+    format_number();
+}
+
+namespace {
+thread_local std::pmr::memory_resource* current_resource = nullptr;
+} // namespace
+
+std::pmr::memory_resource* big_integer_resource() {
+    return current_resource != nullptr ? current_resource
+                                       : std::pmr::get_default_resource();
+}
+
+big_integer_resource_scope::big_integer_resource_scope(
+    std::pmr::memory_resource* r)
+    : previous(current_resource) {
+    current_resource = r;
+}
+
+big_integer_resource_scope::~big_integer_resource_scope() {
+    current_resource = previous;
+}
+
 big_integer::big_integer() = default;
 
-big_integer::big_integer(big_integer const& other) = default;
+big_integer::big_integer(big_integer const& other)
+    : sign(other.sign), number(other.number, big_integer_resource()) {}
+
+big_integer::big_integer(big_integer&& other) noexcept
+    : sign(other.sign), number(std::move(other.number)) {
+    other.sign = 0;
+}
 
-big_integer::big_integer(std::vector<uint32_t>& number, uint32_t sign)
-    : sign(sign), number(number) {
+big_integer::big_integer(limb_vector&& number, uint32_t sign)
+    : sign(sign), number(std::move(number), big_integer_resource()) {
     format_number();
 }
 
@@ -36,7 +192,8 @@ big_integer::big_integer(int16_t a) : big_integer(static_cast<int64_t>(a)) {}
 big_integer::big_integer(int64_t a)
     : sign(a < 0 ? UINT32_MAX : 0),
       number({static_cast<uint32_t>(a & UINT32_MAX),
-              static_cast<uint32_t>(a >> CAPACITY)}) {
+              static_cast<uint32_t>(a >> CAPACITY)},
+             big_integer_resource()) {
     format_number();
 }
 
@@ -44,174 +201,484 @@ big_integer::big_integer(uint32_t a) : big_integer(static_cast<uint64_t>(a)) {}
 big_integer::big_integer(uint16_t a) : big_integer(static_cast<uint64_t>(a)) {}
 big_integer::big_integer(uint64_t a)
     : number({static_cast<uint32_t>(a & UINT32_MAX),
-              static_cast<uint32_t>(a >> CAPACITY)}) {
+              static_cast<uint32_t>(a >> CAPACITY)},
+             big_integer_resource()) {
     format_number();
 }
 
-constexpr std::array<uint32_t, 10> DEC{
-    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
-
-big_integer::big_integer(std::string const& str) {
-    *this = 0;
-    if (str.empty()) {
-        return;
+big_integer::big_integer(std::string_view str) {
+    char const* first = str.data();
+    char const* last = first + str.size();
+    if (last - first > 1 && first[0] == '+' && first[1] != '-') {
+        first++;
     }
-    size_t i = 0;
-    bool minus = false;
-    if (str[0] == '+') {
-        i++;
-    }
-    if (str[0] == '-') {
-        minus = true;
-        i++;
-    }
-    for (; i + 9 <= str.size(); i += 9) {
-        *this *= DEC[9];
-        *this += get_number(str, i, 9);
-    }
-
-    *this *= DEC[str.size() - i];
-    *this += get_number(str, i, str.size() - i);
-
-    if (minus && !is_zero()) {
-        *this = -*this;
+    std::from_chars_result res = from_chars(first, last, *this);
+    if (res.ec != std::errc() || res.ptr != last) {
+        throw std::invalid_argument("invalid big_integer: " + std::string(str));
     }
 }
 
+big_integer::big_integer(big_integer_view v)
+    : sign(v.sign),
+      number(v.digits, v.digits + v.size, big_integer_resource()) {}
+
 big_integer::~big_integer() = default;
 
 big_integer& big_integer::operator=(big_integer const& other) {
-    big_integer(other).swap(*this);
+    sign = other.sign;
+    number = other.number;
     return *this;
 }
 
-big_integer& big_integer::operator+=(big_integer const& rhs) {
-    size_t n = std::max(number.size(), rhs.number.size()) + 2;
+// moves the limbs when both sides share a resource and copies them otherwise
+big_integer& big_integer::operator=(big_integer&& other) {
+    sign = other.sign;
+    number = std::move(other.number);
+    return *this;
+}
+
+// *this += rhs, or *this += ~rhs + 1 when subtracting
+void big_integer::add_view(big_integer_view rhs, bool subtract) {
+    size_t n = std::max(number.size(), rhs.size) + 2;
     number.resize(n, sign);
-    uint32_t carry = 0;
-    for (size_t i = 0; i < rhs.number.size(); i++) {
-        uint64_t sum = static_cast<uint64_t>(carry) + number[i] + rhs.number[i];
-        number[i] = (sum & UINT32_MAX);
+    uint32_t* d = number.data();
+    uint32_t flip = subtract ? UINT32_MAX : 0;
+    uint64_t carry = subtract ? 1 : 0;
+    for (size_t i = 0; i < rhs.size; i++) {
+        uint64_t sum = carry + d[i] + (rhs.digits[i] ^ flip);
+        d[i] = (sum & UINT32_MAX);
         carry = (sum >> CAPACITY);
     }
-    size_t r = rhs.sign;
-    for (size_t i = rhs.number.size(); i < number.size(); i++) {
-        uint64_t sum = static_cast<uint64_t>(carry) + number[i] + r;
-        number[i] = (sum & UINT32_MAX);
+    uint32_t r = rhs.sign ^ flip;
+    for (size_t i = rhs.size; i < n; i++) {
+        uint64_t sum = carry + d[i] + r;
+        d[i] = (sum & UINT32_MAX);
         carry = (sum >> CAPACITY);
     }
     sign = ((number.back() >> (CAPACITY - 1)) != 0 ? UINT32_MAX : 0);
     format_number();
-    return *this;
+}
+
+big_integer& big_integer::operator+=(big_integer const& rhs) {
+    return *this += rhs.view();
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
-    return *this += (-rhs);
+    return *this -= rhs.view();
 }
 
-big_integer& big_integer::operator*=(big_integer const& rhs) {
-    uint32_t minus = sign ^ rhs.sign;
-    big_integer a = abs();
-    big_integer b = rhs.abs();
-    if (a == 0 || b == 0) {
-        return *this = 0;
+// a view of *this would dangle once number is resized, so the in-place
+// operators below work on a copy of it
+big_integer& big_integer::operator+=(big_integer_view rhs) {
+    if (rhs.size != 0 && rhs.digits == number.data()) {
+        return *this += big_integer(rhs);
     }
+    add_view(rhs, false);
+    return *this;
+}
 
-    std::vector<uint32_t> cur(rhs.number.size() + number.size() + 1);
-    uint64_t carry = 0, c = 0, time = 0;
-
-    for (size_t i = 0; i < rhs.number.size(); i++) {
-        carry = 0;
-        for (size_t j = 0; j < number.size(); j++) {
-            c = static_cast<uint64_t>(a.number[j]) * b.number[i];
-            c += carry;
-            time = c + cur[i + j];
-            cur[i + j] = (time & UINT32_MAX);
-            carry = (time >> CAPACITY);
-        }
-        cur[i + number.size()] += carry & UINT32_MAX;
+big_integer& big_integer::operator-=(big_integer_view rhs) {
+    if (rhs.size != 0 && rhs.digits == number.data()) {
+        return *this -= big_integer(rhs);
     }
-    *this = big_integer(cur, false);
+    add_view(rhs, true);
+    return *this;
+}
 
-    if (minus) {
-        *this = -*this;
+namespace {
+std::mutex parallel_mul_mutex;
+std::shared_ptr<thread_pool> parallel_mul_pool;
+size_t parallel_mul_min_limbs = 0;
+
+std::shared_ptr<thread_pool> pool_for_mul(size_t shorter) {
+    if (thread_pool::in_worker()) {
+        return nullptr;
     }
-    format_number();
-    return *this;
+    std::lock_guard<std::mutex> lock(parallel_mul_mutex);
+    if (!parallel_mul_pool || shorter < parallel_mul_min_limbs) {
+        return nullptr;
+    }
+    return parallel_mul_pool;
 }
 
-void big_integer::div_and_mod(big_integer const& a, big_integer const& b,
-                              big_integer& div, big_integer& mod, uint32_t sign_a,
-                              uint32_t sign_b) {
-    if (b.number.size() == 1) {
-        short_div(a, b, div, mod, sign_a, sign_b);
+// splits the longer operand into one stripe per thread, multiplies the
+// stripes concurrently and adds the partial products at their offsets, so
+// the result is bit-for-bit the serial one
+void mul_limbs(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+               uint32_t* out) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    std::shared_ptr<thread_pool> pool = pool_for_mul(m);
+    if (!pool) {
+        scratch ws(mul_space(m));
+        ws->resize(mul_space(m));
+        mul_serial(a, n, b, m, out, ws->data());
         return;
     }
-    uint32_t minus = sign_a ^ sign_b;
+    size_t parts = std::min(pool->size(), n);
+    size_t len = (n + parts - 1) / parts;
+    // borrowed here since the scratch pool belongs to this thread
+    size_t stride = len + m;
+    scratch partial(parts * stride);
+    partial->assign(parts * stride, 0);
+    uint32_t* parts_out = partial->data();
+    size_t space = mul_space(m);
+    scratch ws(parts * space);
+    ws->resize(parts * space);
+    uint32_t* parts_ws = ws->data();
+    pool->run(parts, [&](size_t i) {
+        size_t lo = std::min(n, i * len);
+        size_t hi = std::min(n, lo + len);
+        mul_serial(a + lo, hi - lo, b, m, parts_out + i * stride,
+                   parts_ws + i * space);
+    });
+    for (size_t i = 0; i < parts; i++) {
+        size_t lo = std::min(n, i * len);
+        size_t hi = std::min(n, lo + len);
+        add_limbs(out + lo, n + m - lo, parts_out + i * stride, hi - lo + m);
+    }
+}
+} // namespace
 
-    std::vector<uint32_t> ans;
+void set_parallel_mul(size_t threads, size_t min_limbs) {
+    std::lock_guard<std::mutex> lock(parallel_mul_mutex);
+    parallel_mul_pool.reset();
+    if (threads > 1) {
+        parallel_mul_pool = std::make_shared<thread_pool>(threads - 1);
+    }
+    parallel_mul_min_limbs = min_limbs;
+}
 
-    mod = 0;
+big_integer& big_integer::operator*=(big_integer const& rhs) {
+    return *this *= rhs.view();
+}
 
-    for (size_t ind = a.number.size(); ind != 0; ind--) {
-        mod = (mod << CAPACITY) + a.number[ind - 1];
-        if (mod < b) {
-            ans.push_back(0);
-            continue;
+big_integer& big_integer::operator*=(big_integer_view rhs) {
+    if (is_zero() || rhs.is_zero()) {
+        number.clear();
+        sign = 0;
+        return *this;
+    }
+    uint32_t minus = sign ^ rhs.sign;
+    scratch a(number.size() + 1);
+    scratch b(rhs.size + 1);
+    magnitude(*this, *a);
+    magnitude(rhs, *b);
+
+    scratch cur(a->size() + b->size());
+    cur->assign(a->size() + b->size(), 0);
+    mul_limbs(a->data(), a->size(), b->data(), b->size(), cur->data());
+    number.clear();
+    sign = 0;
+    add_magnitude(cur->data(), cur->size(), minus != 0);
+    return *this;
+}
+
+big_integer& big_integer::add_mul(big_integer const& a, big_integer const& b) {
+    return fused_mul(a, b, false);
+}
+
+big_integer& big_integer::sub_mul(big_integer const& a, big_integer const& b) {
+    return fused_mul(a, b, true);
+}
+
+big_integer& big_integer::fused_mul(big_integer const& a, big_integer const& b,
+                                    bool subtract) {
+    if (a.is_zero() || b.is_zero()) {
+        return *this;
+    }
+    scratch a_abs(a.number.size() + 1);
+    scratch b_abs(b.number.size() + 1);
+    magnitude(a, *a_abs);
+    magnitude(b, *b_abs);
+    scratch prod(a_abs->size() + b_abs->size());
+    prod->assign(a_abs->size() + b_abs->size(), 0);
+    mul_limbs(a_abs->data(), a_abs->size(), b_abs->data(), b_abs->size(),
+              prod->data());
+    add_magnitude(prod->data(), prod->size(), (a.sign != b.sign) != subtract);
+    return *this;
+}
+
+namespace {
+// Knuth's algorithm D: q = u / v and r = u % v for magnitudes with
+// n = v.size() >= 2, v.back() != 0 and u.size() >= n; q gets
+// u.size() - n + 1 limbs and r gets n
+void divide_limbs(limb_vector const& u, limb_vector const& v, limb_vector& q,
+                  limb_vector& r) {
+    size_t n = v.size();
+    size_t m = u.size() - n;
+    // shifting both so that the top bit of v is set keeps every estimated
+    // quotient digit at most two above the real one
+    uint32_t s = __builtin_clz(v.back());
+    scratch vn(n);
+    scratch un(m + n + 1);
+    vn->resize(n);
+    un->resize(m + n + 1);
+    for (size_t i = n - 1; i != 0; i--) {
+        (*vn)[i] = (v[i] << s) | (s != 0 ? v[i - 1] >> (CAPACITY - s) : 0);
+    }
+    (*vn)[0] = v[0] << s;
+    (*un)[m + n] = s != 0 ? u[m + n - 1] >> (CAPACITY - s) : 0;
+    for (size_t i = m + n - 1; i != 0; i--) {
+        (*un)[i] = (u[i] << s) | (s != 0 ? u[i - 1] >> (CAPACITY - s) : 0);
+    }
+    (*un)[0] = u[0] << s;
+
+    uint32_t* w = un->data();
+    uint32_t const* d = vn->data();
+    uint64_t const base = uint64_t(1) << CAPACITY;
+    q.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- != 0;) {
+        uint64_t top = (static_cast<uint64_t>(w[j + n]) << CAPACITY) |
+                       w[j + n - 1];
+        uint64_t qhat = top / d[n - 1];
+        uint64_t rhat = top % d[n - 1];
+        while (qhat >= base ||
+               qhat * d[n - 2] > ((rhat << CAPACITY) | w[j + n - 2])) {
+            qhat--;
+            rhat += d[n - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t p = qhat * d[i] + carry;
+            carry = p >> CAPACITY;
+            uint64_t sub = w[i + j] - (p & UINT32_MAX) - borrow;
+            w[i + j] = static_cast<uint32_t>(sub);
+            borrow = (sub >> CAPACITY) != 0 ? 1 : 0;
         }
-        int new_bit_ans = 0;
-        big_integer sh = b << (CAPACITY);
-        for (int L = CAPACITY - 1; L >= 0; L--) {
-            sh >>= 1;
-            if (sh <= mod) {
-                mod -= sh;
-                new_bit_ans += (1 << L);
+        uint64_t sub = w[j + n] - carry - borrow;
+        w[j + n] = static_cast<uint32_t>(sub);
+        if ((sub >> CAPACITY) != 0) {
+            // qhat was one too large, add v back
+            qhat--;
+            carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = static_cast<uint64_t>(w[i + j]) + d[i] + carry;
+                w[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> CAPACITY;
             }
+            w[j + n] += static_cast<uint32_t>(carry);
         }
-        ans.push_back(new_bit_ans);
+        q[j] = static_cast<uint32_t>(qhat);
     }
-    std::reverse(ans.begin(), ans.end());
-    div = big_integer(ans, false);
-    div.format_number();
-    mod.format_number();
-    if (minus) {
-        div = -div;
+    r.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        r[i] = (w[i] >> s) | (s != 0 ? w[i + 1] << (CAPACITY - s) : 0);
+    }
+}
+} // namespace
+
+// *div = x / y rounded toward zero and *mod = x - y * (x / y); either may be
+// null, and either may be x or y since both are only written at the end
+void big_integer::div_and_mod(big_integer_view x, big_integer_view y,
+                              big_integer* div, big_integer* mod) {
+    scratch u(x.size + 1);
+    scratch v(y.size + 1);
+    magnitude(x, *u);
+    magnitude(y, *v);
+    if (v->empty()) {
+        throw std::domain_error("big_integer division by zero");
+    }
+    bool minus = (x.sign != y.sign);
+    bool minus_mod = (x.sign != 0);
+    scratch q(u->size() + 1);
+    scratch r(v->size());
+    if (u->size() < v->size()) {
+        std::swap(*r, *u);
+    } else if (v->size() == 1) {
+        uint32_t d = (*v)[0];
+        uint64_t rest = 0;
+        q->resize(u->size());
+        for (size_t i = u->size(); i != 0; i--) {
+            uint64_t cur = (rest << CAPACITY) | (*u)[i - 1];
+            (*q)[i - 1] = static_cast<uint32_t>(cur / d);
+            rest = cur % d;
+        }
+        r->push_back(static_cast<uint32_t>(rest));
+    } else {
+        divide_limbs(*u, *v, *q, *r);
     }
-    if (sign_a) {
-        mod = -mod;
+    if (div != nullptr) {
+        div->number.clear();
+        div->sign = 0;
+        div->add_magnitude(q->data(), q->size(), minus);
+    }
+    if (mod != nullptr) {
+        mod->number.clear();
+        mod->sign = 0;
+        mod->add_magnitude(r->data(), r->size(), minus_mod);
     }
 }
 
 big_integer& big_integer::operator/=(big_integer const& rhs) {
-    big_integer tr;
-    div_and_mod(abs(), rhs.abs(), *this, tr, sign, rhs.sign);
-    return *this;
+    return *this /= rhs.view();
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs) {
-    big_integer tr;
-    div_and_mod(abs(), rhs.abs(), tr, *this, sign, rhs.sign);
+    return *this %= rhs.view();
+}
+
+big_integer& big_integer::operator/=(big_integer_view rhs) {
+    div_and_mod(*this, rhs, this, nullptr);
+    return *this;
+}
+
+big_integer& big_integer::operator%=(big_integer_view rhs) {
+    div_and_mod(*this, rhs, nullptr, this);
     return *this;
 }
 
+namespace {
+struct and_op {
+    uint32_t operator()(uint32_t x, uint32_t y) const {
+        return x & y;
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y) const {
+        return _mm_and_si128(x, y);
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y) const {
+        return _mm256_and_si256(x, y);
+    }
+#endif
+};
+
+struct or_op {
+    uint32_t operator()(uint32_t x, uint32_t y) const {
+        return x | y;
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y) const {
+        return _mm_or_si128(x, y);
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y) const {
+        return _mm256_or_si256(x, y);
+    }
+#endif
+};
+
+struct xor_op {
+    uint32_t operator()(uint32_t x, uint32_t y) const {
+        return x ^ y;
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y) const {
+        return _mm_xor_si128(x, y);
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y) const {
+        return _mm256_xor_si256(x, y);
+    }
+#endif
+};
+
+// dst[i] = op(a[i], b[i]) for i < n, dst may be a
+template <typename Op>
+void bitwise_limbs(uint32_t* dst, uint32_t const* a, uint32_t const* b,
+                   size_t n, Op op) {
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), op(x, y));
+    }
+#endif
+#ifdef __SSE2__
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), op(x, y));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = op(a[i], b[i]);
+    }
+}
+
+// dst[i] = op(a[i], fill) for i < n, dst may be a
+template <typename Op>
+void bitwise_fill(uint32_t* dst, uint32_t const* a, uint32_t fill, size_t n,
+                  Op op) {
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256i y8 = _mm256_set1_epi32(static_cast<int>(fill));
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), op(x, y8));
+    }
+#endif
+#ifdef __SSE2__
+    __m128i y4 = _mm_set1_epi32(static_cast<int>(fill));
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), op(x, y4));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = op(a[i], fill);
+    }
+}
+} // namespace
+
 big_integer& big_integer::operator&=(big_integer const& rhs) {
-    return bitwise(rhs, [](uint32_t& x, uint32_t y) { x &= y; });
+    return *this &= rhs.view();
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) {
-    return bitwise(rhs, [](uint32_t& x, uint32_t y) { x |= y; });
+    return *this |= rhs.view();
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) {
-    return bitwise(rhs, [](uint32_t& x, uint32_t y) { x ^= y; });
+    return *this ^= rhs.view();
+}
+
+big_integer& big_integer::operator&=(big_integer_view rhs) {
+    if (rhs.size != 0 && rhs.digits == number.data()) {
+        return *this &= big_integer(rhs);
+    }
+    return bitwise(rhs, and_op());
+}
+
+big_integer& big_integer::operator|=(big_integer_view rhs) {
+    if (rhs.size != 0 && rhs.digits == number.data()) {
+        return *this |= big_integer(rhs);
+    }
+    return bitwise(rhs, or_op());
 }
 
+big_integer& big_integer::operator^=(big_integer_view rhs) {
+    if (rhs.size != 0 && rhs.digits == number.data()) {
+        return *this ^= big_integer(rhs);
+    }
+    return bitwise(rhs, xor_op());
+}
+
+// the magnitude of a negative count is taken in unsigned arithmetic, as
+// -INT_MIN does not fit in an int
 big_integer& big_integer::operator<<=(int rhs) {
-    return make_shift(rhs, false);
+    if (rhs < 0) {
+        return make_shift(0u - static_cast<unsigned>(rhs), true);
+    }
+    return make_shift(static_cast<size_t>(rhs), false);
 }
 
 big_integer& big_integer::operator>>=(int rhs) {
-    return make_shift(rhs, true);
+    if (rhs < 0) {
+        return make_shift(0u - static_cast<unsigned>(rhs), false);
+    }
+    return make_shift(static_cast<size_t>(rhs), true);
 }
 
 big_integer big_integer::operator+() const {
@@ -223,7 +690,7 @@ big_integer big_integer::operator-() const {
         return *this;
     }
     size_t n = number.size() + 1;
-    std::vector<uint32_t> ans(n, sign);
+    limb_vector ans(n, sign, big_integer_resource());
     uint32_t carry = 1;
     for (size_t i = 0; i < number.size(); i++) {
         uint64_t sum = static_cast<uint64_t>(carry) + (number[i] ^ UINT32_MAX);
@@ -235,17 +702,15 @@ big_integer big_integer::operator-() const {
     } else {
         ans.pop_back();
     }
-    return big_integer(ans, ~sign);
+    return big_integer(std::move(ans), ~sign);
 }
 
 big_integer big_integer::operator~() const {
-    big_integer cur = *this;
-    for (size_t i = 0; i < number.size(); i++) {
-        cur.number[i] ^= UINT32_MAX;
-    }
-
+    big_integer cur;
+    cur.number.resize(number.size());
+    bitwise_fill(cur.number.data(), number.data(), UINT32_MAX, number.size(),
+                 xor_op());
     cur.sign = ~sign;
-    cur.format_number();
     return cur;
 }
 
@@ -301,6 +766,38 @@ big_integer operator^(big_integer a, big_integer const& b) {
     return a ^= b;
 }
 
+big_integer operator+(big_integer a, big_integer_view b) {
+    return a += b;
+}
+
+big_integer operator-(big_integer a, big_integer_view b) {
+    return a -= b;
+}
+
+big_integer operator*(big_integer a, big_integer_view b) {
+    return a *= b;
+}
+
+big_integer operator/(big_integer a, big_integer_view b) {
+    return a /= b;
+}
+
+big_integer operator%(big_integer a, big_integer_view b) {
+    return a %= b;
+}
+
+big_integer operator&(big_integer a, big_integer_view b) {
+    return a &= b;
+}
+
+big_integer operator|(big_integer a, big_integer_view b) {
+    return a |= b;
+}
+
+big_integer operator^(big_integer a, big_integer_view b) {
+    return a ^= b;
+}
+
 big_integer operator<<(big_integer a, int b) {
     return a <<= b;
 }
@@ -310,7 +807,7 @@ big_integer operator>>(big_integer a, int b) {
 }
 
 bool operator==(big_integer const& a, big_integer const& b) {
-    return (a.sign == b.sign && a.number == b.number);
+    return (a.sign == b.sign && a.number.get() == b.number.get());
 }
 
 bool operator!=(big_integer const& a, big_integer const& b) {
@@ -318,25 +815,7 @@ bool operator!=(big_integer const& a, big_integer const& b) {
 }
 
 bool operator<(big_integer const& a, big_integer const& b) {
-    if (a.sign != b.sign) {
-        return a.sign != 0 && b.sign == 0;
-    }
-    if (a.sign != 0) {
-        if (a.number.size() != b.number.size()) {
-            return a.number.size() > b.number.size();
-        }
-    } else {
-        if (a.number.size() != b.number.size()) {
-            return a.number.size() < b.number.size();
-        }
-    }
-
-    for (size_t i = a.number.size(); i != 0; i--) {
-        if (a.number[i - 1] != b.number[i - 1]) {
-            return a.number[i - 1] < b.number[i - 1];
-        }
-    }
-    return false;
+    return compare(a, b) < 0;
 }
 
 bool operator>(big_integer const& a, big_integer const& b) {
@@ -351,6 +830,46 @@ bool operator>=(big_integer const& a, big_integer const& b) {
     return !(a < b);
 }
 
+int compare(big_integer_view a, big_integer_view b) {
+    if (a.sign != b.sign) {
+        return a.sign != 0 ? -1 : 1;
+    }
+    if (a.size != b.size) {
+        // more limbs means further from zero
+        return (a.size < b.size) != (a.sign != 0) ? -1 : 1;
+    }
+    for (size_t i = a.size; i != 0; i--) {
+        if (a.digits[i - 1] != b.digits[i - 1]) {
+            return a.digits[i - 1] < b.digits[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+bool operator==(big_integer_view a, big_integer_view b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_integer_view a, big_integer_view b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_integer_view a, big_integer_view b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) >= 0;
+}
+
 big_integer big_integer::abs() const {
     if (sign != 0) {
         return -*this;
@@ -359,6 +878,14 @@ big_integer big_integer::abs() const {
     }
 }
 
+big_integer_view big_integer::view() const {
+    return *this;
+}
+
+std::pmr::memory_resource* big_integer::resource() const {
+    return number.resource();
+}
+
 uint32_t big_integer::get_digit(size_t ind) const {
     if (ind < number.size()) {
         return number[ind];
@@ -366,132 +893,836 @@ uint32_t big_integer::get_digit(size_t ind) const {
     return sign;
 }
 
-std::string to_string(big_integer const& a) {
-    std::string ans;
-    big_integer cur = a.abs();
-    big_integer m;
-    while (cur != 0) {
-        big_integer::div_and_mod(cur.abs(), DEC[9], cur, m, false, false);
-        std::string next =
-            std::to_string((!m.number.empty() ? m.number[0] : 0));
-        if (next.size() != 9 && cur != 0) {
-            next = std::string(9 - next.size(), '0').append(next);
+namespace {
+constexpr char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+constexpr char UPPER_DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// value of c as a digit, 36 for characters that are not digits in any base
+uint32_t char_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    return 36;
+}
+
+// the largest power of base that fits in a limb, and its exponent
+struct radix {
+    uint32_t chunk;
+    uint32_t power;
+};
+
+radix radix_for(uint32_t base) {
+    if (base == 10) {
+        return {9, DEC[9]};
+    }
+    radix res{1, base};
+    while (static_cast<uint64_t>(res.power) * base <= UINT32_MAX) {
+        res.power *= base;
+        res.chunk++;
+    }
+    return res;
+}
+
+// limbs = limbs * mul + add
+void mul_add_small(limb_vector& limbs, uint32_t mul, uint32_t add) {
+    uint64_t carry = add;
+    for (uint32_t& limb : limbs) {
+        uint64_t cur = static_cast<uint64_t>(limb) * mul + carry;
+        limb = (cur & UINT32_MAX);
+        carry = (cur >> CAPACITY);
+    }
+    if (carry != 0) {
+        limbs.push_back(carry);
+    }
+}
+
+// limbs = limbs * mul + add for a multiplier of up to 64 bits
+void mul_add_wide(limb_vector& limbs, uint64_t mul, uint64_t add) {
+    unsigned __int128 carry = add;
+    for (uint32_t& limb : limbs) {
+        unsigned __int128 cur =
+            static_cast<unsigned __int128>(limb) * mul + carry;
+        limb = static_cast<uint32_t>(cur);
+        carry = (cur >> CAPACITY);
+    }
+    for (; carry != 0; carry >>= CAPACITY) {
+        limbs.push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// limbs /= d, returns the remainder
+uint32_t div_small(limb_vector& limbs, uint32_t d) {
+    uint64_t rest = 0;
+    for (size_t i = limbs.size(); i != 0; i--) {
+        uint64_t cur = (rest << CAPACITY) | limbs[i - 1];
+        limbs[i - 1] = cur / d;
+        rest = cur % d;
+    }
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+    return rest;
+}
+
+// digits of limbs in chunks of r.chunk digits, least significant first;
+// destroys limbs
+void radix_chunks(limb_vector& limbs, radix r, limb_vector& chunks) {
+    chunks.clear();
+    while (!limbs.empty()) {
+        chunks.push_back(div_small(limbs, r.power));
+    }
+    if (chunks.empty()) {
+        chunks.push_back(0);
+    }
+}
+
+size_t digit_count(uint32_t value, uint32_t base) {
+    size_t res = 1;
+    for (; value >= base; value /= base) {
+        res++;
+    }
+    return res;
+}
+
+// writes value as exactly len digits ending at out + len
+void put_digits(char* out, uint32_t value, size_t len, uint32_t base,
+                char const* digits = DIGITS) {
+    for (size_t i = len; i != 0; i--) {
+        out[i - 1] = digits[value % base];
+        value /= base;
+    }
+}
+
+// log2(base) for bases 2, 4, 8, 16 and 32, 0 for the others
+uint32_t pow2_bits(int base) {
+    return (base & (base - 1)) == 0 ? __builtin_ctz(base) : 0;
+}
+
+// reads the digits of [first, last) in base 2^bits, least significant
+// digit last, straight into limbs
+void parse_pow2(char const* first, char const* last, uint32_t bits,
+                limb_vector& limbs) {
+    limbs.assign(((last - first) * bits + CAPACITY - 1) / CAPACITY + 1, 0);
+    uint64_t acc = 0;
+    uint32_t filled = 0;
+    size_t j = 0;
+    for (char const* p = last; p != first;) {
+        acc |= static_cast<uint64_t>(char_digit(*--p)) << filled;
+        filled += bits;
+        if (filled >= CAPACITY) {
+            limbs[j++] = (acc & UINT32_MAX);
+            acc >>= CAPACITY;
+            filled -= CAPACITY;
         }
-        ans = next.append(ans);
     }
-    if (ans.empty()) {
-        ans = "0";
+    limbs[j] = acc;
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
     }
+}
 
-    if (a.sign != 0) {
-        ans = "-" + ans;
+// writes the two limbs hi:lo as 16 hex digits
+void put_hex16(char* out, uint32_t hi, uint32_t lo) {
+#ifdef __SSSE3__
+    uint64_t v = (static_cast<uint64_t>(hi) << CAPACITY) | lo;
+    __m128i x = _mm_cvtsi64_si128(static_cast<long long>(v));
+    __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i low = _mm_and_si128(x, mask);
+    __m128i high = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+    // high, low nibble of byte 0, then of byte 1, ...; reversed so that the
+    // most significant byte comes first
+    __m128i nibbles = _mm_unpacklo_epi8(high, low);
+    nibbles = _mm_shuffle_epi8(
+        nibbles, _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3,
+                               0, 1));
+    __m128i table = _mm_loadu_si128(reinterpret_cast<__m128i const*>(DIGITS));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_shuffle_epi8(table, nibbles));
+#else
+    put_digits(out, hi, 8, 16);
+    put_digits(out + 8, lo, 8, 16);
+#endif
+}
+
+// base 2^bits output by regrouping the bits of the magnitude, which is
+// produced limb by limb from the two's complement digits
+std::to_chars_result to_chars_pow2(char* first, char* last,
+                                   big_integer const& value, bool negative,
+                                   uint32_t bits) {
+    size_t length = value.bit_length();
+    if (negative && value.popcount() == length) {
+        // -2^k, the magnitude is one bit longer than ~value
+        length++;
+    }
+    size_t count = std::max<size_t>(1, (length + bits - 1) / bits);
+    size_t len = count + (negative ? 1 : 0);
+    if (static_cast<size_t>(last - first) < len) {
+        return {last, std::errc::value_too_large};
     }
+    if (negative) {
+        *first = '-';
+    }
+    char* end = first + len;
+
+    uint32_t flip = negative ? UINT32_MAX : 0;
+    uint64_t carry = negative ? 1 : 0;
+    size_t limb = 0;
+    auto next_limb = [&]() {
+        uint64_t cur = (value.get_digit(limb++) ^ flip) + carry;
+        carry = (cur >> CAPACITY);
+        return static_cast<uint32_t>(cur & UINT32_MAX);
+    };
+
+    size_t done = 0;
+    if (bits == 4) {
+        for (; done + 16 <= count; done += 16) {
+            uint32_t lo = next_limb();
+            uint32_t hi = next_limb();
+            put_hex16(end - done - 16, hi, lo);
+        }
+    }
+    uint64_t acc = 0;
+    uint32_t filled = 0;
+    for (; done < count; done++) {
+        if (filled < bits) {
+            acc |= static_cast<uint64_t>(next_limb()) << filled;
+            filled += CAPACITY;
+        }
+        *(end - done - 1) = DIGITS[acc & ((1u << bits) - 1)];
+        acc >>= bits;
+        filled -= bits;
+    }
+    return {end, std::errc()};
+}
+} // namespace
 
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, int base) {
+    if (base < 2 || base > 36) {
+        return {first, std::errc::invalid_argument};
+    }
+    char const* digits = first;
+    bool minus = digits != last && *digits == '-';
+    if (minus) {
+        digits++;
+    }
+    char const* end = digits;
+    if (base == 10) {
+        end += count_digits(digits, last);
+    }
+    while (end != last && char_digit(*end) < static_cast<uint32_t>(base)) {
+        end++;
+    }
+    if (end == digits) {
+        return {first, std::errc::invalid_argument};
+    }
+
+    scratch limb_buf((end - digits) / 9 + 2);
+    limb_vector& limbs = *limb_buf;
+    uint32_t bits = pow2_bits(base);
+    if (bits != 0) {
+        parse_pow2(digits, end, bits, limbs);
+    } else if (base == 10) {
+        // chunks of 19 digits, the most a 64-bit word holds
+        size_t head = (end - digits) % 19;
+        mul_add_wide(limbs, 0, parse_digits(digits, head));
+        for (char const* p = digits + head; p != end; p += 19) {
+            mul_add_wide(limbs, DEC19, parse_digits(p, 19));
+        }
+    } else {
+        radix r = radix_for(base);
+        size_t head = (end - digits) % r.chunk;
+        if (head != 0) {
+            mul_add_small(limbs, 0,
+                          big_integer::get_number(digits, head, base));
+        }
+        for (char const* p = digits + head; p != end; p += r.chunk) {
+            mul_add_small(limbs, r.power,
+                          big_integer::get_number(p, r.chunk, base));
+        }
+    }
+    value.number.clear();
+    value.sign = 0;
+    value.add_magnitude(limbs.data(), limbs.size(), minus);
+    return {end, std::errc()};
+}
+
+std::to_chars_result to_chars(char* first, char* last,
+                              big_integer const& value, int base) {
+    if (base < 2 || base > 36) {
+        return {last, std::errc::invalid_argument};
+    }
+    if (pow2_bits(base) != 0) {
+        return to_chars_pow2(first, last, value, value.sign != 0,
+                             pow2_bits(base));
+    }
+    radix r = radix_for(base);
+    scratch limbs(value.number.size() + 1);
+    big_integer::magnitude(value, *limbs);
+    // every base here has r.power >= 2^16, two chunks per limb at most
+    scratch chunk_buf(2 * limbs->size() + 1);
+    limb_vector& chunks = *chunk_buf;
+    radix_chunks(*limbs, r, chunks);
+
+    size_t top = digit_count(chunks.back(), base);
+    size_t len =
+        (value.sign != 0 ? 1 : 0) + top + (chunks.size() - 1) * r.chunk;
+    if (static_cast<size_t>(last - first) < len) {
+        return {last, std::errc::value_too_large};
+    }
+    char* out = first;
+    if (value.sign != 0) {
+        *out++ = '-';
+    }
+    put_digits(out, chunks.back(), top, base);
+    out += top;
+    size_t i = chunks.size() - 1;
+    if (base == 10) {
+        // pairs of 9-digit chunks go through the 18-digit leaf kernel
+        if (i % 2 != 0) {
+            format_digits(chunks[--i], out, 9);
+            out += 9;
+        }
+        for (; i != 0; i -= 2) {
+            format_digits(chunks[i - 1] * static_cast<uint64_t>(DEC[9]) +
+                              chunks[i - 2],
+                          out, 18);
+            out += 18;
+        }
+    }
+    for (; i != 0; i--) {
+        put_digits(out, chunks[i - 1], r.chunk, base);
+        out += r.chunk;
+    }
+    return {out, std::errc()};
+}
+
+size_t to_chars_size(big_integer const& value, int base) {
+    double bits = static_cast<double>(value.number.size() + 1) * CAPACITY;
+    return static_cast<size_t>(bits / std::log2(base)) + 2;
+}
+
+std::string to_string(big_integer const& a) {
+    return to_string(a, 10);
+}
+
+std::string to_string(big_integer const& a, int base) {
+    std::string ans(to_chars_size(a, base), '\0');
+    std::to_chars_result res =
+        to_chars(ans.data(), ans.data() + ans.size(), a, base);
+    ans.resize(res.ptr - ans.data());
     return ans;
 }
 
+// vector::swap needs equal allocators, limbs in different resources are
+// exchanged through moves, which copy them
 void big_integer::swap(big_integer& integer) {
     std::swap(sign, integer.sign);
-    std::swap(number, integer.number);
+    number.swap(integer.number);
 }
-uint32_t big_integer::get_number(const std::string& basicString, size_t i,
-                                 size_t i1) {
+uint32_t big_integer::get_number(char const* str, size_t len,
+                                 uint32_t base) {
     uint32_t ans = 0;
-    for (size_t k = i; k < i1 + i; k++) {
-        ans = ans * DEC[1] + (basicString[k] - '0');
+    for (size_t k = 0; k < len; k++) {
+        ans = ans * base + char_digit(str[k]);
     }
     return ans;
 }
-void big_integer::short_div(const big_integer& a, const big_integer& b,
-                            big_integer& div, big_integer& mod, uint32_t sign_a,
-                            uint32_t sign_b) {
-    uint32_t minus = sign_a ^ sign_b;
+template <typename Op>
+big_integer& big_integer::bitwise(big_integer_view rhs, Op op) {
+    size_t n = std::max(number.size(), rhs.size);
+    number.resize(n, sign);
+    size_t m = rhs.size;
+    bitwise_limbs(number.data(), number.data(), rhs.digits, m, op);
+    uint32_t fill = rhs.sign;
+    if (op(0, fill) == op(UINT32_MAX, fill)) {
+        std::fill(number.begin() + m, number.end(), op(0, fill));
+    } else if (op(0, fill) != 0) {
+        bitwise_fill(number.data() + m, number.data() + m, fill, n - m, op);
+    }
+    sign = op(sign, rhs.sign);
+    format_number();
+    return *this;
+}
+namespace {
+// dst[i] = (src[i] >> s) | (src[i + 1] << (32 - s)) for i < n, 0 < s < 32;
+// dst may be src
+void shift_right_limbs(uint32_t* dst, uint32_t const* src, size_t n,
+                       uint32_t s) {
+    size_t i = 0;
+#ifdef __AVX2__
+    __m128i r = _mm_cvtsi32_si128(static_cast<int>(s));
+    __m128i l = _mm_cvtsi32_si128(static_cast<int>(CAPACITY - s));
+    for (; i + 8 <= n; i += 8) {
+        __m256i lo =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        __m256i hi =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i + 1));
+        __m256i res =
+            _mm256_or_si256(_mm256_srl_epi32(lo, r), _mm256_sll_epi32(hi, l));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), res);
+    }
+#elif defined(__SSE2__)
+    __m128i r = _mm_cvtsi32_si128(static_cast<int>(s));
+    __m128i l = _mm_cvtsi32_si128(static_cast<int>(CAPACITY - s));
+    for (; i + 4 <= n; i += 4) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i + 1));
+        __m128i res = _mm_or_si128(_mm_srl_epi32(lo, r), _mm_sll_epi32(hi, l));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = (src[i] >> s) | (src[i + 1] << (CAPACITY - s));
+    }
+}
 
-    std::vector<uint32_t> ans;
+// dst[i] = (src[i] << s) | (src[i - 1] >> (32 - s)) for 0 < i < n, and
+// dst[0] = src[0] << s, 0 < s < 32; dst may be src
+void shift_left_limbs(uint32_t* dst, uint32_t const* src, size_t n,
+                      uint32_t s) {
+    size_t i = n;
+#ifdef __AVX2__
+    __m128i l = _mm_cvtsi32_si128(static_cast<int>(s));
+    __m128i r = _mm_cvtsi32_si128(static_cast<int>(CAPACITY - s));
+    for (; i >= 9; i -= 8) {
+        __m256i hi =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i - 8));
+        __m256i lo =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i - 9));
+        __m256i res =
+            _mm256_or_si256(_mm256_sll_epi32(hi, l), _mm256_srl_epi32(lo, r));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i - 8), res);
+    }
+#elif defined(__SSE2__)
+    __m128i l = _mm_cvtsi32_si128(static_cast<int>(s));
+    __m128i r = _mm_cvtsi32_si128(static_cast<int>(CAPACITY - s));
+    for (; i >= 5; i -= 4) {
+        __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i - 4));
+        __m128i lo =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i - 5));
+        __m128i res = _mm_or_si128(_mm_sll_epi32(hi, l), _mm_srl_epi32(lo, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i - 4), res);
+    }
+#endif
+    for (; i > 1; i--) {
+        dst[i - 1] = (src[i - 1] << s) | (src[i - 2] >> (CAPACITY - s));
+    }
+    if (n != 0) {
+        dst[0] = src[0] << s;
+    }
+}
+} // namespace
 
-    mod = 0;
-    uint32_t d = b.number[0];
-    for (size_t ind = a.number.size(); ind != 0; ind--) {
-        mod = (mod << CAPACITY) + a.number[ind - 1];
-        if (mod < d) {
-            ans.push_back(0);
-            continue;
+big_integer& big_integer::make_shift(size_t count, bool right) {
+    size_t words = count >> LOG_CAPACITY;
+    uint32_t bits = count & (CAPACITY - 1);
+    size_t n = number.size();
+    if (right) {
+        if (words >= n) {
+            number.clear();
+            return *this;
         }
-        if (mod.number.size() == 1) {
-            ans.push_back(mod.number[0] / d);
-            mod.number[0] %= d;
-        } else {
-            uint64_t cur = (static_cast<uint64_t>(mod.number[1]) << CAPACITY) +
-                           mod.number[0];
-            ans.push_back(cur / d);
-            mod.number[0] = cur % d;
+        std::memmove(number.data(), number.data() + words,
+                     (n - words) * sizeof(uint32_t));
+        number.resize(n - words);
+        if (bits != 0) {
+            number.push_back(sign);
+            shift_right_limbs(number.data(), number.data(), n - words, bits);
+            number.pop_back();
+        }
+    } else {
+        if (is_zero()) {
+            return *this;
+        }
+        number.resize(n + words + (bits != 0 ? 1 : 0), sign);
+        if (words != 0) {
+            std::memmove(number.data() + words, number.data(),
+                         n * sizeof(uint32_t));
+            std::fill(number.begin(), number.begin() + words, 0);
+        }
+        if (bits != 0) {
+            shift_left_limbs(number.data() + words, number.data() + words,
+                             n + 1, bits);
         }
     }
-    std::reverse(ans.begin(), ans.end());
-    div = big_integer(ans, false);
-    div.format_number();
-    mod.format_number();
-    if (minus) {
-        div = -div;
+    format_number();
+    return *this;
+}
+
+size_t big_integer::bit_length() const {
+    if (number.empty()) {
+        return 0;
     }
-    if (sign_a != 0) {
-        mod = -mod;
+    uint32_t top = number.back() ^ sign;
+    return number.size() * CAPACITY - __builtin_clz(top);
+}
+
+size_t big_integer::popcount() const {
+    size_t res = 0;
+    for (uint32_t digit : number) {
+        res += __builtin_popcount(digit ^ sign);
     }
+    return res;
 }
-big_integer& big_integer::bitwise(const big_integer& rhs,
-                                  void (*opration)(uint32_t&, uint32_t)) {
-    size_t n = std::max(number.size(), rhs.number.size());
-    number.resize(n, sign);
-    for (size_t i = 0; i < rhs.number.size(); i++) {
-        opration(number[i], rhs.number[i]);
+
+// zero has no set bits, count_trailing_zeros() returns 0 for it
+size_t big_integer::count_trailing_zeros() const {
+    for (size_t i = 0; i < number.size(); i++) {
+        if (number[i] != 0) {
+            return i * CAPACITY + __builtin_ctz(number[i]);
+        }
+    }
+    return sign != 0 ? number.size() * CAPACITY : 0;
+}
+
+bool big_integer::test_bit(size_t n) const {
+    return ((get_digit(n >> LOG_CAPACITY) >> (n & (CAPACITY - 1))) & 1) != 0;
+}
+
+big_integer& big_integer::set_bit(size_t n) {
+    if (!test_bit(n)) {
+        number.resize(std::max(number.size(), (n >> LOG_CAPACITY) + 1), sign);
+        number[n >> LOG_CAPACITY] |= (1u << (n & (CAPACITY - 1)));
+        format_number();
     }
-    size_t si = rhs.sign;
-    for (size_t i = rhs.number.size(); i < number.size(); i++) {
-        opration(number[i], si);
+    return *this;
+}
+
+big_integer& big_integer::clear_bit(size_t n) {
+    if (test_bit(n)) {
+        number.resize(std::max(number.size(), (n >> LOG_CAPACITY) + 1), sign);
+        number[n >> LOG_CAPACITY] &= ~(1u << (n & (CAPACITY - 1)));
+        format_number();
     }
-    opration(sign, rhs.sign);
-    format_number();
     return *this;
 }
-big_integer& big_integer::make_shift(int rhs, bool right) {
-    if (rhs == 0) {
-        return *this;
+
+namespace {
+uint32_t stream_base(std::ios_base const& s) {
+    std::ios_base::fmtflags base = s.flags() & std::ios_base::basefield;
+    if (base == std::ios_base::hex) {
+        return 16;
     }
-    size_t shift_div = rhs >> LOG_CAPACITY;
-    size_t shift_mod = rhs & (CAPACITY - 1);
-    size_t n = number.size() + (right ? -1 : 1) * shift_div + 1;
-    number.resize(std::max(number.size(), n), sign);
-    if (right) {
-        n--;
-        for (size_t i = 0; i < n; i++) {
-            uint64_t x =
-                static_cast<uint64_t>(number[i + shift_div]) >> shift_mod;
-            uint64_t y = static_cast<uint64_t>(get_digit(i + shift_div + 1))
-                      << (CAPACITY - shift_mod);
-            number[i] = ((x | y) & UINT32_MAX);
+    if (base == std::ios_base::oct) {
+        return 8;
+    }
+    return 10;
+}
+
+// digits of limbs in base 2^bits grouped into chunks of `digits` digits,
+// least significant first
+void pow2_chunks(limb_vector const& limbs, uint32_t bits, uint32_t digits,
+                 limb_vector& chunks) {
+    uint32_t chunk_bits = bits * digits;
+    chunks.clear();
+    uint64_t acc = 0;
+    uint32_t filled = 0;
+    for (uint32_t limb : limbs) {
+        acc |= static_cast<uint64_t>(limb) << filled;
+        filled += CAPACITY;
+        for (; filled >= chunk_bits; filled -= chunk_bits) {
+            chunks.push_back(acc & ((uint64_t(1) << chunk_bits) - 1));
+            acc >>= chunk_bits;
         }
+    }
+    if (acc != 0 || chunks.empty()) {
+        chunks.push_back(acc);
+    }
+    while (chunks.size() > 1 && chunks.back() == 0) {
+        chunks.pop_back();
+    }
+}
+
+// fixed-size block of output that is handed to the stream buffer whenever
+// it fills up
+struct stream_writer {
+    explicit stream_writer(std::ostream& s) : buf(s.rdbuf()) {}
+
+    char* reserve(size_t n) {
+        if (used + n > BLOCK) {
+            flush();
+        }
+        char* res = block + used;
+        used += n;
+        return res;
+    }
+
+    void put(char c, size_t n = 1) {
+        for (; n != 0; n--) {
+            *reserve(1) = c;
+        }
+    }
+
+    bool flush() {
+        auto n = static_cast<std::streamsize>(used);
+        ok = ok && buf->sputn(block, n) == n;
+        used = 0;
+        return ok;
+    }
+
+    static constexpr size_t BLOCK = 4096;
+    std::streambuf* buf;
+    bool ok{true};
+    size_t used{0};
+    char block[BLOCK];
+};
+} // namespace
+
+// digits are produced as limb-sized chunks and written to the stream in
+// blocks, so the full decimal string is never built
+std::ostream& operator<<(std::ostream& s, big_integer const& a) {
+    std::ostream::sentry guard(s);
+    if (!guard) {
+        return s;
+    }
+    std::ios_base::fmtflags flags = s.flags();
+    uint32_t base = stream_base(s);
+    scratch limbs(a.number.size() + 1);
+    big_integer::magnitude(a, *limbs);
+    uint32_t bits = pow2_bits(base);
+    radix r = radix_for(base);
+    if (bits != 0) {
+        r.chunk = CAPACITY / bits;
+    }
+    scratch chunk_buf(2 * limbs->size() + 1);
+    limb_vector& chunks = *chunk_buf;
+    if (bits != 0) {
+        pow2_chunks(*limbs, bits, r.chunk, chunks);
     } else {
-        for (size_t i = n - 1; i > shift_div; i--) {
-            uint64_t x = static_cast<uint64_t>(number[i - shift_div])
-                      << shift_mod;
-            uint64_t y = static_cast<uint64_t>(number[i - shift_div - 1]) >>
-                         (CAPACITY - shift_mod);
-            number[i] = ((x | y) & UINT32_MAX);
+        radix_chunks(*limbs, r, chunks);
+    }
+
+    std::string prefix;
+    if (a.sign != 0) {
+        prefix = "-";
+    } else if (flags & std::ios_base::showpos) {
+        prefix = "+";
+    }
+    // uppercase applies to the digits and the prefix, never to the fill
+    bool upper = (flags & std::ios_base::uppercase) != 0;
+    char const* digits = upper ? UPPER_DIGITS : DIGITS;
+    if ((flags & std::ios_base::showbase) && base != 10 && !a.is_zero()) {
+        prefix += base == 16 ? (upper ? "0X" : "0x") : "0";
+    }
+    size_t top = digit_count(chunks.back(), base);
+    size_t len = prefix.size() + top + (chunks.size() - 1) * r.chunk;
+    size_t width = s.width() > 0 ? static_cast<size_t>(s.width()) : 0;
+    size_t pad = width > len ? width - len : 0;
+    std::ios_base::fmtflags adjust = flags & std::ios_base::adjustfield;
+
+    stream_writer out(s);
+    if (adjust != std::ios_base::left && adjust != std::ios_base::internal) {
+        out.put(s.fill(), pad);
+    }
+    for (char c : prefix) {
+        out.put(c);
+    }
+    if (adjust == std::ios_base::internal) {
+        out.put(s.fill(), pad);
+    }
+    put_digits(out.reserve(top), chunks.back(), top, base, digits);
+    for (size_t i = chunks.size() - 1; i != 0; i--) {
+        if (base == 10) {
+            format_digits(chunks[i - 1], out.reserve(r.chunk), r.chunk);
+        } else {
+            put_digits(out.reserve(r.chunk), chunks[i - 1], r.chunk, base,
+                       digits);
         }
-        number[shift_div] = (number[0] << shift_mod) & UINT32_MAX;
     }
-    for (size_t i = n; i < number.size(); i++) {
-        number[i] = sign;
+    if (adjust == std::ios_base::left) {
+        out.put(s.fill(), pad);
+    }
+    if (!out.flush()) {
+        s.setstate(std::ios_base::badbit);
+    }
+    s.width(0);
+    return s;
+}
+
+// reads an optional sign and the longest run of digits in the stream's
+// base, one character at a time; hex input may start with 0x
+std::istream& operator>>(std::istream& s, big_integer& a) {
+    std::istream::sentry guard(s);
+    if (!guard) {
+        return s;
+    }
+    uint32_t base = stream_base(s);
+    uint32_t bits = pow2_bits(base);
+    radix r = radix_for(base);
+    if (bits != 0) {
+        r.chunk = CAPACITY / bits;
     }
-    if (!right) {
-        for (size_t i = shift_div; i != 0; i--) {
-            number[i - 1] = 0;
+    std::streambuf* buf = s.rdbuf();
+    using traits = std::char_traits<char>;
+    int c = buf->sgetc();
+    bool minus = false;
+    if (c == '-' || c == '+') {
+        minus = c == '-';
+        c = buf->snextc();
+    }
+    bool any = false;
+    if (base == 16 && c == '0') {
+        any = true;
+        c = buf->snextc();
+        if (c == 'x' || c == 'X') {
+            c = buf->snextc();
         }
     }
-    format_number();
-    return *this;
+
+    // chunks of r.chunk digits, most significant first; the last one holds
+    // `last` digits
+    scratch chunk_buf(0);
+    limb_vector& chunks = *chunk_buf;
+    uint32_t cur = 0;
+    uint32_t last = 0;
+    for (; c != traits::eof() && char_digit(static_cast<char>(c)) < base;
+         c = buf->snextc()) {
+        if (last == r.chunk) {
+            chunks.push_back(cur);
+            cur = 0;
+            last = 0;
+        }
+        cur = cur * base + char_digit(static_cast<char>(c));
+        last++;
+        any = true;
+    }
+    std::ios_base::iostate state = std::ios_base::goodbit;
+    if (c == traits::eof()) {
+        state |= std::ios_base::eofbit;
+    }
+    if (!any) {
+        a = 0;
+        s.setstate(state | std::ios_base::failbit);
+        return s;
+    }
+    chunks.push_back(cur);
+
+    scratch limb_buf(chunks.size() + 1);
+    limb_vector& limbs = *limb_buf;
+    if (bits != 0) {
+        uint64_t acc = 0;
+        uint32_t filled = 0;
+        for (size_t i = chunks.size(); i != 0; i--) {
+            acc |= static_cast<uint64_t>(chunks[i - 1]) << filled;
+            filled += (i == chunks.size() ? last : r.chunk) * bits;
+            if (filled >= CAPACITY) {
+                limbs.push_back(acc & UINT32_MAX);
+                acc >>= CAPACITY;
+                filled -= CAPACITY;
+            }
+        }
+        limbs.push_back(acc);
+    } else {
+        for (size_t i = 0; i + 1 < chunks.size(); i++) {
+            mul_add_small(limbs, r.power, chunks[i]);
+        }
+        uint32_t power = 1;
+        for (uint32_t i = 0; i < last; i++) {
+            power *= base;
+        }
+        mul_add_small(limbs, power, cur);
+    }
+    a.number.clear();
+    a.sign = 0;
+    a.add_magnitude(limbs.data(), limbs.size(), minus);
+    s.setstate(state);
+    return s;
 }
 
-std::ostream& operator<<(std::ostream& s, big_integer const& a) {
-    return s << to_string(a);
+namespace {
+std::vector<uint32_t> primes_up_to(uint32_t n) {
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite(static_cast<size_t>(n) + 1);
+    for (uint64_t i = 2; i <= n; i++) {
+        if (composite[i]) {
+            continue;
+        }
+        primes.push_back(i);
+        for (uint64_t j = i * i; j <= n; j += i) {
+            composite[j] = true;
+        }
+    }
+    return primes;
+}
+
+// packs factors into machine words and multiplies the words as a balanced
+// tree, so the big multiplications get operands of about the same length
+big_integer product_of(std::vector<uint32_t> const& factors) {
+    std::vector<uint64_t> words;
+    uint64_t cur = 1;
+    for (uint32_t f : factors) {
+        if (cur > UINT64_MAX / f) {
+            words.push_back(cur);
+            cur = 1;
+        }
+        cur *= f;
+    }
+    words.push_back(cur);
+    return product(words.begin(), words.end());
+}
+
+// odd part of the prime swing n! / ((n / 2)!)^2
+big_integer odd_swing(uint32_t n, std::vector<uint32_t> const& primes) {
+    std::vector<uint32_t> factors;
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; i++) {
+        for (uint32_t q = n / primes[i]; q != 0; q /= primes[i]) {
+            if (q & 1) {
+                factors.push_back(primes[i]);
+            }
+        }
+    }
+    return product_of(factors);
+}
+
+big_integer odd_factorial(uint32_t n, std::vector<uint32_t> const& primes) {
+    if (n < 2) {
+        return 1;
+    }
+    big_integer half = odd_factorial(n / 2, primes);
+    return half * half * odd_swing(n, primes);
+}
+} // namespace
+
+big_integer factorial(uint32_t n) {
+    uint32_t twos = n - __builtin_popcount(n);
+    return odd_factorial(n, primes_up_to(n)) << static_cast<int>(twos);
+}
+
+big_integer binomial(uint32_t n, uint32_t k) {
+    if (k > n) {
+        return 0;
+    }
+    std::vector<uint32_t> factors;
+    uint32_t twos = 0;
+    for (uint32_t p : primes_up_to(n)) {
+        uint32_t e = 0;
+        for (uint64_t q = p; q <= n; q *= p) {
+            e += n / q - k / q - (n - k) / q;
+        }
+        if (p == 2) {
+            twos = e;
+        } else {
+            factors.insert(factors.end(), e, p);
+        }
+    }
+    return product_of(factors) << static_cast<int>(twos);
+}
+
+big_integer gcd(big_integer a, big_integer b) {
+    a = a.abs();
+    b = b.abs();
+    while (!b.is_zero()) {
+        a %= b;
+        std::swap(a, b);
+    }
+    return a;
 }
@@ -1,33 +1,120 @@
 #pragma once
 
+#include "limb_storage.h"
+#include <charconv>
 #include <iosfwd>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
+struct big_integer;
+
+// resource the big_integers created on this thread take their limbs from,
+// std::pmr::get_default_resource() outside of a big_integer_resource_scope
+std::pmr::memory_resource* big_integer_resource();
+
+// makes r the resource of every big_integer created on this thread until the
+// scope ends; r is only used from this thread, and values that outlive it
+// keep using it. Scratch space inside operations comes from a per-thread
+// pool instead, see set_scratch_limit()
+struct big_integer_resource_scope {
+    explicit big_integer_resource_scope(std::pmr::memory_resource* r);
+    big_integer_resource_scope(big_integer_resource_scope const& other) =
+        delete;
+    big_integer_resource_scope&
+    operator=(big_integer_resource_scope const& other) = delete;
+    ~big_integer_resource_scope();
+
+private:
+    std::pmr::memory_resource* previous;
+};
+
+// read-only value in the form big_integer stores it (two's complement limbs,
+// least significant first, no redundant sign limbs) over limbs owned by
+// someone else, e.g. a deserialized buffer; the limbs must outlive the view
+struct big_integer_view {
+    big_integer_view() = default;
+    big_integer_view(big_integer const& a);
+    big_integer_view(uint32_t const* digits, size_t size, bool negative)
+        : digits(digits), size(size), sign(negative ? UINT32_MAX : 0) {}
+
+    uint32_t get_digit(size_t ind) const {
+        return ind < size ? digits[ind] : sign;
+    }
+    bool is_zero() const {
+        return sign == 0 && size == 0;
+    }
+
+    uint32_t const* digits{nullptr};
+    size_t size{0};
+    uint32_t sign{0};
+};
+
 struct big_integer {
     big_integer();
     big_integer(big_integer const& other);
+    // takes over the limbs and with them the resource of other
+    big_integer(big_integer&& other) noexcept;
     big_integer(int32_t a);
     big_integer(uint32_t a);
     big_integer(int64_t a);
     big_integer(uint64_t a);
-    explicit big_integer(std::string const& str);
+    // throws std::invalid_argument unless str is a whole decimal number
+    explicit big_integer(std::string_view str);
+    explicit big_integer(big_integer_view v);
     big_integer(int16_t a);
     big_integer(uint16_t a);
     ~big_integer();
 
+    // evaluation targets for the lazy expressions of big_integer_expr.h
+    template <typename E, typename = typename E::is_expression>
+    big_integer(E const& e) : big_integer() {
+        e.evaluate(*this);
+    }
+    template <typename E, typename = typename E::is_expression>
+    big_integer& operator=(E const& e) {
+        e.evaluate(*this);
+        return *this;
+    }
+    template <typename E, typename = typename E::is_expression>
+    big_integer& operator+=(E const& e) {
+        e.accumulate(*this, false);
+        return *this;
+    }
+    template <typename E, typename = typename E::is_expression>
+    big_integer& operator-=(E const& e) {
+        e.accumulate(*this, true);
+        return *this;
+    }
+
+    // the limbs stay in the resource *this was created with
     big_integer& operator=(big_integer const& other);
+    big_integer& operator=(big_integer&& other);
 
     big_integer& operator+=(big_integer const& rhs);
     big_integer& operator-=(big_integer const& rhs);
     big_integer& operator*=(big_integer const& rhs);
     big_integer& operator/=(big_integer const& rhs);
     big_integer& operator%=(big_integer const& rhs);
+    big_integer& operator+=(big_integer_view rhs);
+    big_integer& operator-=(big_integer_view rhs);
+    big_integer& operator*=(big_integer_view rhs);
+    big_integer& operator/=(big_integer_view rhs);
+    big_integer& operator%=(big_integer_view rhs);
+
+    // *this += a * b and *this -= a * b without a temporary for the product
+    big_integer& add_mul(big_integer const& a, big_integer const& b);
+    big_integer& sub_mul(big_integer const& a, big_integer const& b);
 
     big_integer& operator&=(big_integer const& rhs);
     big_integer& operator|=(big_integer const& rhs);
     big_integer& operator^=(big_integer const& rhs);
+    big_integer& operator&=(big_integer_view rhs);
+    big_integer& operator|=(big_integer_view rhs);
+    big_integer& operator^=(big_integer_view rhs);
 
+    // a negative count shifts the other way, so a << -k == a >> k
     big_integer& operator<<=(int rhs);
     big_integer& operator>>=(int rhs);
 
@@ -42,9 +129,20 @@ struct big_integer {
     big_integer operator--(int);
 
     big_integer abs() const;
+    big_integer_view view() const;
+    std::pmr::memory_resource* resource() const;
     uint32_t get_digit(size_t ind) const;
     bool is_zero() const;
 
+    // bit queries on the infinite two's complement form; for negative values
+    // bit_length() and popcount() look at the bits that differ from the sign
+    size_t bit_length() const;
+    size_t popcount() const;
+    size_t count_trailing_zeros() const;
+    bool test_bit(size_t n) const;
+    big_integer& set_bit(size_t n);
+    big_integer& clear_bit(size_t n);
+
     friend bool operator==(big_integer const& a, big_integer const& b);
     friend bool operator!=(big_integer const& a, big_integer const& b);
     friend bool operator<(big_integer const& a, big_integer const& b);
@@ -53,26 +151,42 @@ struct big_integer {
     friend bool operator>=(big_integer const& a, big_integer const& b);
 
     friend std::string to_string(big_integer const& a);
+    friend std::from_chars_result from_chars(char const* first,
+                                             char const* last,
+                                             big_integer& value, int base);
+    friend std::to_chars_result to_chars(char* first, char* last,
+                                         big_integer const& value, int base);
+    friend size_t to_chars_size(big_integer const& value, int base);
+    friend std::ostream& operator<<(std::ostream& s, big_integer const& a);
+    friend std::istream& operator>>(std::istream& s, big_integer& a);
+    friend std::from_chars_result deserialize(char const* first,
+                                              char const* last,
+                                              big_integer& value);
 
 private:
-    big_integer(std::vector<uint32_t>& number, uint32_t sign);
+    friend struct big_accumulator;
+    friend struct big_integer_view;
+    template <char... Cs>
+    friend big_integer operator""_bi();
+
+    big_integer(limb_vector&& number, uint32_t sign);
     void format_number();
-    big_integer& make_shift(int rhs, bool b);
-    big_integer& bitwise(const big_integer& integer,
-                         void (*opration)(uint32_t&, uint32_t));
-    static void div_and_mod(big_integer const& x, big_integer const& y,
-                            big_integer& div, big_integer& mod, uint32_t s_x,
-                            uint32_t s_y);
+    static void magnitude(big_integer_view v, limb_vector& out);
+    void add_view(big_integer_view rhs, bool subtract);
+    void add_magnitude(uint32_t const* digits, size_t len, bool negative);
+    big_integer& fused_mul(big_integer const& a, big_integer const& b,
+                           bool subtract);
+    big_integer& make_shift(size_t count, bool right);
+    template <typename Op>
+    big_integer& bitwise(big_integer_view rhs, Op op);
+    static void div_and_mod(big_integer_view x, big_integer_view y,
+                            big_integer* div, big_integer* mod);
     void swap(big_integer& integer);
-    static uint32_t get_number(const std::string& basicString, size_t i,
-                               size_t i1);
-    static void short_div(const big_integer& a, const big_integer& b,
-                          big_integer& div, big_integer& mul, uint32_t sign_a,
-                          uint32_t sign_b);
+    static uint32_t get_number(char const* str, size_t len, uint32_t base);
 
 private:
     uint32_t sign{0};
-    std::vector<uint32_t> number;
+    limb_storage number{big_integer_resource()};
 };
 
 big_integer operator+(big_integer a, big_integer const& b);
@@ -85,6 +199,16 @@ big_integer operator&(big_integer a, big_integer const& b);
 big_integer operator|(big_integer a, big_integer const& b);
 big_integer operator^(big_integer a, big_integer const& b);
 
+big_integer operator+(big_integer a, big_integer_view b);
+big_integer operator-(big_integer a, big_integer_view b);
+big_integer operator*(big_integer a, big_integer_view b);
+big_integer operator/(big_integer a, big_integer_view b);
+big_integer operator%(big_integer a, big_integer_view b);
+
+big_integer operator&(big_integer a, big_integer_view b);
+big_integer operator|(big_integer a, big_integer_view b);
+big_integer operator^(big_integer a, big_integer_view b);
+
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
@@ -95,5 +219,59 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+// negative, zero or positive as a is less than, equal to or greater than b
+int compare(big_integer_view a, big_integer_view b);
+
+bool operator==(big_integer_view a, big_integer_view b);
+bool operator!=(big_integer_view a, big_integer_view b);
+bool operator<(big_integer_view a, big_integer_view b);
+bool operator>(big_integer_view a, big_integer_view b);
+bool operator<=(big_integer_view a, big_integer_view b);
+bool operator>=(big_integer_view a, big_integer_view b);
+
 std::string to_string(big_integer const& a);
+// bases 2, 4, 8, 16 and 32 are converted in linear time
+std::string to_string(big_integer const& a, int base);
+
+// <charconv>-style conversions in bases 2 to 36 that work on caller buffers:
+// from_chars accepts an optional '-' followed by digits and reports the
+// first unparsed character, to_chars fails with errc::value_too_large when
+// the buffer is shorter than to_chars_size(value, base)
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, int base = 10);
+std::to_chars_result to_chars(char* first, char* last,
+                              big_integer const& value, int base = 10);
+size_t to_chars_size(big_integer const& value, int base = 10);
+
+// both honour the stream's basefield (dec, hex, oct); output also honours
+// showpos, showbase, uppercase, width and adjustfield
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+std::istream& operator>>(std::istream& s, big_integer& a);
+
+// multiplications whose shorter operand has at least min_limbs limbs are
+// split across `threads` threads; threads <= 1 turns this off (the default)
+void set_parallel_mul(size_t threads, size_t min_limbs = 1024);
+
+// operations borrow their scratch buffers from a pool of the calling thread,
+// which keeps up to `bytes` of them (4 MiB by default) for later calls;
+// trim_scratch() frees what the calling thread's pool holds
+void set_scratch_limit(size_t bytes);
+void trim_scratch();
+
+big_integer factorial(uint32_t n);
+big_integer binomial(uint32_t n, uint32_t k);
+// greatest common divisor of |a| and |b|; gcd(0, 0) = 0
+big_integer gcd(big_integer a, big_integer b);
+
+template <typename It>
+big_integer product(It first, It last) {
+    auto n = std::distance(first, last);
+    if (n == 0) {
+        return 1;
+    }
+    if (n == 1) {
+        return big_integer(*first);
+    }
+    It mid = std::next(first, n / 2);
+    return product(first, mid) * product(mid, last);
+}
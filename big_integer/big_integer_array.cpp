@@ -0,0 +1,203 @@
+#include "big_integer_array.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr size_t CAPACITY = 32;
+
+// writes |v| to out, which must have room for v.size + 1 limbs, and returns
+// its length without the zero high limbs
+size_t magnitude(big_integer_view v, uint32_t* out) {
+    std::copy_n(v.digits, v.size, out);
+    out[v.size] = v.sign;
+    size_t n = v.size + 1;
+    if (v.sign != 0) {
+        uint64_t carry = 1;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t sum = carry + (~out[i] & UINT32_MAX);
+            out[i] = (sum & UINT32_MAX);
+            carry = (sum >> CAPACITY);
+        }
+    }
+    while (n != 0 && out[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+[[noreturn]] void too_long() {
+    throw std::length_error("big_integer_array: element too long");
+}
+} // namespace
+
+big_integer_array::big_integer_array(std::pmr::memory_resource* r)
+    : pool(r), index(r) {}
+
+size_t big_integer_array::size() const {
+    return index.size();
+}
+
+bool big_integer_array::empty() const {
+    return index.empty();
+}
+
+size_t big_integer_array::limbs() const {
+    return pool.size();
+}
+
+void big_integer_array::reserve(size_t count, size_t limbs) {
+    index.reserve(count);
+    pool.reserve(limbs);
+}
+
+void big_integer_array::clear() {
+    index.clear();
+    pool.clear();
+}
+
+big_integer_view big_integer_array::operator[](size_t i) const {
+    entry const& e = index[i];
+    return big_integer_view(pool.data() + e.offset, e.size, e.sign != 0);
+}
+
+void big_integer_array::push_back(big_integer_view v) {
+    if (v.size > MAX_LIMBS) {
+        too_long();
+    }
+    size_t offset = pool.size();
+    std::less<uint32_t const*> before;
+    if (v.size != 0 && !before(v.digits, pool.data()) &&
+        before(v.digits, pool.data() + offset)) {
+        // v is an element of *this, which the resize below may move
+        size_t from = v.digits - pool.data();
+        pool.resize(offset + v.size);
+        std::copy_n(pool.data() + from, v.size, pool.data() + offset);
+    } else {
+        pool.insert(pool.end(), v.digits, v.digits + v.size);
+    }
+    try {
+        index.push_back({offset, static_cast<uint32_t>(v.size), v.sign});
+    } catch (...) {
+        pool.resize(offset);
+        throw;
+    }
+}
+
+void big_integer_array::commit(size_t offset, uint32_t sign) {
+    while (pool.size() > offset && pool.back() == sign) {
+        pool.pop_back();
+    }
+    if (pool.size() - offset > MAX_LIMBS) {
+        pool.resize(offset);
+        too_long();
+    }
+    index.push_back(
+        {offset, static_cast<uint32_t>(pool.size() - offset), sign});
+}
+
+int big_integer_array::compare(size_t i, size_t j) const {
+    return ::compare((*this)[i], (*this)[j]);
+}
+
+void big_integer_array::sort() {
+    auto less = [this](entry const& a, entry const& b) {
+        big_integer_view x(pool.data() + a.offset, a.size, a.sign != 0);
+        big_integer_view y(pool.data() + b.offset, b.size, b.sign != 0);
+        return ::compare(x, y) < 0;
+    };
+    std::sort(index.begin(), index.end(), less);
+    big_integer_array sorted(pool.get_allocator().resource());
+    sorted.reserve(size(), limbs());
+    for (size_t i = 0; i < size(); i++) {
+        sorted.push_back((*this)[i]);
+    }
+    *this = std::move(sorted);
+}
+
+void big_integer_array::add(big_integer_view rhs) {
+    big_integer_array result(pool.get_allocator().resource());
+    result.reserve(size(), limbs() + size() * (rhs.size + 2));
+    for (size_t k = 0; k < size(); k++) {
+        big_integer_view x = (*this)[k];
+        size_t n = std::max(x.size, rhs.size) + 2;
+        size_t offset = result.pool.size();
+        result.pool.resize(offset + n);
+        uint32_t* d = result.pool.data() + offset;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t sum = carry + x.get_digit(i) + rhs.get_digit(i);
+            d[i] = (sum & UINT32_MAX);
+            carry = (sum >> CAPACITY);
+        }
+        result.commit(offset, (d[n - 1] >> (CAPACITY - 1)) != 0 ? UINT32_MAX
+                                                                 : 0);
+    }
+    *this = std::move(result);
+}
+
+void big_integer_array::mul(big_integer_view rhs) {
+    limb_vector b(rhs.size + 1, pool.get_allocator().resource());
+    size_t lb = magnitude(rhs, b.data());
+    limb_vector a(pool.get_allocator().resource());
+
+    big_integer_array result(pool.get_allocator().resource());
+    result.reserve(size(), limbs() + size() * (lb + 1));
+    for (size_t k = 0; k < size(); k++) {
+        big_integer_view x = (*this)[k];
+        uint32_t const* digits = x.digits;
+        size_t la = x.size;
+        if (x.sign != 0) {
+            a.resize(x.size + 1);
+            la = magnitude(x, a.data());
+            digits = a.data();
+        }
+        size_t offset = result.pool.size();
+        if (la == 0 || lb == 0) {
+            result.commit(offset, 0);
+            continue;
+        }
+        size_t n = la + lb;
+        result.pool.resize(offset + n);
+        uint32_t* d = result.pool.data() + offset;
+        std::fill_n(d, n, 0);
+        for (size_t i = 0; i < la; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < lb; j++) {
+                uint64_t cur = uint64_t(digits[i]) * b[j] + d[i + j] + carry;
+                d[i + j] = (cur & UINT32_MAX);
+                carry = (cur >> CAPACITY);
+            }
+            d[i + lb] = static_cast<uint32_t>(carry);
+        }
+        // -m is stored as 2^(32 n) - m with the sign filling the limbs above
+        bool negative = (x.sign != 0) != (rhs.sign != 0);
+        if (negative) {
+            uint64_t carry = 1;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = carry + (~d[i] & UINT32_MAX);
+                d[i] = (sum & UINT32_MAX);
+                carry = (sum >> CAPACITY);
+            }
+        }
+        result.commit(offset, negative ? UINT32_MAX : 0);
+    }
+    *this = std::move(result);
+}
+
+bool operator==(big_integer_array const& a, big_integer_array const& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (compare(a[i], b[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator!=(big_integer_array const& a, big_integer_array const& b) {
+    return !(a == b);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Sequence of integers whose limbs are packed one after another into a single
+// buffer, with a 16-byte index entry per element instead of a big_integer and a
+// heap block of its own. Elements are read as views that stay valid until the
+// array is modified. Each element may have up to MAX_LIMBS limbs.
+struct big_integer_array {
+    static constexpr size_t MAX_LIMBS = UINT32_MAX;
+
+    explicit big_integer_array(
+        std::pmr::memory_resource* r = big_integer_resource());
+
+    size_t size() const;
+    bool empty() const;
+    // total number of limbs of all elements
+    size_t limbs() const;
+    void reserve(size_t count, size_t limbs);
+    void clear();
+
+    big_integer_view operator[](size_t i) const;
+    // throws std::length_error, leaving the array unchanged, when v has more
+    // than MAX_LIMBS limbs; so do add() and mul() for a result that would
+    void push_back(big_integer_view v);
+
+    // compare((*this)[i], (*this)[j])
+    int compare(size_t i, size_t j) const;
+    // sorts the elements in ascending order and lays their limbs out in the
+    // new order, so that scans stay sequential
+    void sort();
+
+    // adds rhs to every element
+    void add(big_integer_view rhs);
+    // multiplies every element by rhs; meant for short rhs, as every product
+    // is computed by the schoolbook method
+    void mul(big_integer_view rhs);
+
+private:
+    struct entry {
+        size_t offset;
+        uint32_t size;
+        uint32_t sign;
+    };
+
+    // appends the limbs of a value that were just written to the end of pool
+    // at offset, dropping the redundant high ones; throws std::length_error
+    // with the limbs taken back off when more than MAX_LIMBS remain
+    void commit(size_t offset, uint32_t sign);
+
+private:
+    limb_vector pool;
+    std::pmr::vector<entry> index;
+};
+
+bool operator==(big_integer_array const& a, big_integer_array const& b);
+bool operator!=(big_integer_array const& a, big_integer_array const& b);
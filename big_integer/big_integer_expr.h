@@ -0,0 +1,162 @@
+#pragma once
+
+#include "big_integer.h"
+#include <type_traits>
+
+// Lazy arithmetic on big_integer. Wrapping an operand in lazy() makes +, -
+// and * build an expression tree instead of temporaries; the tree is
+// evaluated when it is assigned to (or added to) a big_integer, with products
+// in a sum folded into add_mul/sub_mul:
+//
+//     big_integer r = lazy(a) * b + lazy(c) * d - e;
+//
+// Expressions hold references to their operands and must not outlive them.
+namespace big_integer_expr {
+template <typename Derived>
+struct expression {
+    using is_expression = void;
+
+    void evaluate(big_integer& dest) const {
+        if (self().aliases(dest)) {
+            big_integer tmp;
+            self().eval_into(tmp);
+            dest = tmp;
+        } else {
+            self().eval_into(dest);
+        }
+    }
+
+    void accumulate(big_integer& dest, bool negate) const {
+        if (self().aliases(dest)) {
+            big_integer tmp;
+            self().eval_into(tmp);
+            negate ? dest -= tmp : dest += tmp;
+        } else {
+            self().add_into(dest, negate);
+        }
+    }
+
+private:
+    Derived const& self() const {
+        return static_cast<Derived const&>(*this);
+    }
+};
+
+struct ref : expression<ref> {
+    explicit ref(big_integer const& value) : value(value) {}
+
+    bool aliases(big_integer const& x) const {
+        return &value == &x;
+    }
+    void eval_into(big_integer& dest) const {
+        dest = value;
+    }
+    void add_into(big_integer& dest, bool negate) const {
+        negate ? dest -= value : dest += value;
+    }
+
+    big_integer const& value;
+};
+
+inline big_integer const& materialize(ref const& e) {
+    return e.value;
+}
+
+template <typename E>
+big_integer materialize(E const& e) {
+    big_integer res;
+    e.eval_into(res);
+    return res;
+}
+
+template <typename L, typename R, bool Minus>
+struct sum : expression<sum<L, R, Minus>> {
+    sum(L const& l, R const& r) : l(l), r(r) {}
+
+    bool aliases(big_integer const& x) const {
+        return l.aliases(x) || r.aliases(x);
+    }
+    void eval_into(big_integer& dest) const {
+        l.eval_into(dest);
+        r.add_into(dest, Minus);
+    }
+    void add_into(big_integer& dest, bool negate) const {
+        l.add_into(dest, negate);
+        r.add_into(dest, negate != Minus);
+    }
+
+    L l;
+    R r;
+};
+
+template <typename L, typename R>
+struct product : expression<product<L, R>> {
+    product(L const& l, R const& r) : l(l), r(r) {}
+
+    bool aliases(big_integer const& x) const {
+        return l.aliases(x) || r.aliases(x);
+    }
+    void eval_into(big_integer& dest) const {
+        l.eval_into(dest);
+        dest *= materialize(r);
+    }
+    void add_into(big_integer& dest, bool negate) const {
+        auto const& a = materialize(l);
+        auto const& b = materialize(r);
+        negate ? dest.sub_mul(a, b) : dest.add_mul(a, b);
+    }
+
+    L l;
+    R r;
+};
+
+template <typename T>
+using is_node = std::is_base_of<expression<T>, T>;
+
+template <typename L, typename R>
+using enable_nodes =
+    std::enable_if_t<is_node<L>::value && is_node<R>::value, int>;
+
+template <typename L, typename R, enable_nodes<L, R> = 0>
+sum<L, R, false> operator+(L const& l, R const& r) {
+    return {l, r};
+}
+template <typename L, typename R, enable_nodes<L, R> = 0>
+sum<L, R, true> operator-(L const& l, R const& r) {
+    return {l, r};
+}
+template <typename L, typename R, enable_nodes<L, R> = 0>
+product<L, R> operator*(L const& l, R const& r) {
+    return {l, r};
+}
+
+template <typename L, enable_nodes<L, L> = 0>
+sum<L, ref, false> operator+(L const& l, big_integer const& r) {
+    return {l, ref(r)};
+}
+template <typename L, enable_nodes<L, L> = 0>
+sum<L, ref, true> operator-(L const& l, big_integer const& r) {
+    return {l, ref(r)};
+}
+template <typename L, enable_nodes<L, L> = 0>
+product<L, ref> operator*(L const& l, big_integer const& r) {
+    return {l, ref(r)};
+}
+
+template <typename R, enable_nodes<R, R> = 0>
+sum<ref, R, false> operator+(big_integer const& l, R const& r) {
+    return {ref(l), r};
+}
+template <typename R, enable_nodes<R, R> = 0>
+sum<ref, R, true> operator-(big_integer const& l, R const& r) {
+    return {ref(l), r};
+}
+template <typename R, enable_nodes<R, R> = 0>
+product<ref, R> operator*(big_integer const& l, R const& r) {
+    return {ref(l), r};
+}
+} // namespace big_integer_expr
+
+inline big_integer_expr::ref lazy(big_integer const& a) {
+    return big_integer_expr::ref(a);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "big_integer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace literal_detail {
+template <size_t N>
+struct literal_digits {
+    std::array<uint32_t, N> digits{};
+    size_t size = 0;
+};
+
+constexpr uint32_t digit_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return UINT32_MAX;
+}
+
+struct literal_prefix {
+    uint32_t base;
+    size_t length;
+};
+
+// base of an integer literal from its 0x, 0b or 0 prefix
+constexpr literal_prefix prefix(char const* str, size_t len) {
+    if (len > 1 && str[0] == '0') {
+        if (str[1] == 'x' || str[1] == 'X') {
+            return {16, 2};
+        }
+        if (str[1] == 'b' || str[1] == 'B') {
+            return {2, 2};
+        }
+        return {8, 1};
+    }
+    return {10, 0};
+}
+
+// whether the characters form an integer literal: after the prefix only
+// digits of its base and separators, so floating literals such as 1.5 or
+// 1e5 and digits such as the 2 in 0b12 are rejected
+template <char... Cs>
+constexpr bool valid() {
+    constexpr size_t LEN = sizeof...(Cs);
+    constexpr char str[LEN] = {Cs...};
+    literal_prefix p = prefix(str, LEN);
+    bool digits = false;
+    for (size_t i = p.length; i < LEN; i++) {
+        if (str[i] == '\'') {
+            continue;
+        }
+        if (digit_value(str[i]) >= p.base) {
+            return false;
+        }
+        digits = true;
+    }
+    return digits;
+}
+
+// converts the characters of an integer literal (with 0x, 0b or 0 prefix and
+// digit separators) into little-endian limbs at compile time
+template <char... Cs>
+constexpr auto parse() {
+    constexpr size_t LEN = sizeof...(Cs);
+    constexpr char str[LEN] = {Cs...};
+    // every digit of any base fits in four bits
+    literal_digits<(LEN * 4 + 31) / 32 + 1> res;
+    literal_prefix p = prefix(str, LEN);
+    for (size_t i = p.length; i < LEN; i++) {
+        if (str[i] == '\'') {
+            continue;
+        }
+        uint64_t carry = digit_value(str[i]);
+        for (size_t j = 0; j < res.size; j++) {
+            uint64_t cur =
+                static_cast<uint64_t>(res.digits[j]) * p.base + carry;
+            res.digits[j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        if (carry != 0) {
+            res.digits[res.size++] = static_cast<uint32_t>(carry);
+        }
+    }
+    return res;
+}
+} // namespace literal_detail
+
+// 123456789012345678901234567890_bi, parsed at compile time; the only run
+// time work is one allocation for the limbs of a non-zero value. Floating
+// literals and digits outside the base fail to compile
+template <char... Cs>
+big_integer operator""_bi() {
+    static_assert(literal_detail::valid<Cs...>(),
+                  "_bi takes integer literals with digits of their base");
+    static constexpr auto value = literal_detail::parse<Cs...>();
+    limb_vector digits(value.digits.begin(), value.digits.begin() + value.size,
+                       big_integer_resource());
+    return big_integer(std::move(digits), 0);
+}
@@ -0,0 +1,255 @@
+#include "big_rational.h"
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// a sum reduces once the denominator has more than twice the bits it had
+// after the last reduction plus this many
+constexpr size_t LAZY_BITS = 1024;
+
+int signum(big_integer const& a) {
+    return a.is_zero() ? 0 : a < 0 ? -1 : 1;
+}
+} // namespace
+
+big_rational::big_rational() = default;
+
+big_rational::big_rational(big_integer num) : num(std::move(num)) {}
+
+big_rational::big_rational(big_integer num, big_integer den)
+    : num(std::move(num)), den(std::move(den)) {
+    if (this->den.is_zero()) {
+        throw std::domain_error("big_rational with a zero denominator");
+    }
+    if (this->den < 0) {
+        this->num = -this->num;
+        this->den = -this->den;
+    }
+    reduced = (this->den == 1);
+    reduced_bits = this->den.bit_length();
+}
+
+big_integer const& big_rational::numerator() const {
+    return num;
+}
+
+big_integer const& big_rational::denominator() const {
+    return den;
+}
+
+bool big_rational::is_normalized() const {
+    return reduced;
+}
+
+big_rational& big_rational::normalize() {
+    if (!reduced) {
+        big_integer g = gcd(num, den);
+        if (g != 1) {
+            num /= g;
+            den /= g;
+        }
+        reduced = true;
+    }
+    reduced_bits = den.bit_length();
+    return *this;
+}
+
+void big_rational::reduce_if_large() {
+    if (!reduced && den.bit_length() > 2 * reduced_bits + LAZY_BITS) {
+        normalize();
+    }
+}
+
+// a / b + c / d = (a d + c b) / (b d), or (a + c) / b when b = d
+void big_rational::add(big_rational const& rhs, bool subtract) {
+    if (den == rhs.den) {
+        if (subtract) {
+            num -= rhs.num;
+        } else {
+            num += rhs.num;
+        }
+        reduced = reduced && den == 1;
+    } else {
+        num *= rhs.den;
+        if (subtract) {
+            num.sub_mul(rhs.num, den);
+        } else {
+            num.add_mul(rhs.num, den);
+        }
+        den *= rhs.den;
+        reduced = false;
+    }
+    reduce_if_large();
+}
+
+big_rational& big_rational::operator+=(big_rational const& rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+big_rational& big_rational::operator-=(big_rational const& rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+// (a / b) (c / d) = ((a / g) (c / h)) / ((b / h) (d / g)) with g = gcd(a, d)
+// and h = gcd(c, b): two gcds of the factors instead of one of the products,
+// and the result is in lowest terms when both operands are
+big_rational& big_rational::operator*=(big_rational const& rhs) {
+    if (&rhs == this) {
+        num *= num;
+        den *= den;
+        return *this;
+    }
+    if (num.is_zero() || rhs.num.is_zero()) {
+        return *this = big_rational();
+    }
+    big_integer g = gcd(num, rhs.den);
+    big_integer h = gcd(rhs.num, den);
+    if (g != 1) {
+        num /= g;
+    }
+    if (h != 1) {
+        den /= h;
+        num *= rhs.num / h;
+    } else {
+        num *= rhs.num;
+    }
+    if (g != 1) {
+        den *= rhs.den / g;
+    } else {
+        den *= rhs.den;
+    }
+    reduced = reduced && rhs.reduced;
+    reduce_if_large();
+    return *this;
+}
+
+big_rational& big_rational::operator/=(big_rational const& rhs) {
+    if (rhs.num.is_zero()) {
+        throw std::domain_error("division by zero");
+    }
+    big_rational inverse;
+    inverse.num = rhs.den;
+    inverse.den = rhs.num;
+    if (inverse.den < 0) {
+        inverse.num = -inverse.num;
+        inverse.den = -inverse.den;
+    }
+    inverse.reduced = rhs.reduced;
+    return *this *= inverse;
+}
+
+// adding an integer keeps the fraction in lowest terms
+big_rational& big_rational::operator+=(big_integer const& rhs) {
+    num.add_mul(rhs, den);
+    return *this;
+}
+
+big_rational& big_rational::operator-=(big_integer const& rhs) {
+    num.sub_mul(rhs, den);
+    return *this;
+}
+
+big_rational& big_rational::operator*=(big_integer const& rhs) {
+    if (rhs.is_zero()) {
+        return *this = big_rational();
+    }
+    big_integer g = gcd(rhs, den);
+    if (g != 1) {
+        den /= g;
+        num *= rhs / g;
+    } else {
+        num *= rhs;
+    }
+    return *this;
+}
+
+big_rational big_rational::operator+() const {
+    return *this;
+}
+
+big_rational big_rational::operator-() const {
+    big_rational res = *this;
+    res.num = -res.num;
+    return res;
+}
+
+big_rational operator+(big_rational a, big_rational const& b) {
+    return a += b;
+}
+
+big_rational operator-(big_rational a, big_rational const& b) {
+    return a -= b;
+}
+
+big_rational operator*(big_rational a, big_rational const& b) {
+    return a *= b;
+}
+
+big_rational operator/(big_rational a, big_rational const& b) {
+    return a /= b;
+}
+
+int compare(big_rational const& a, big_rational const& b) {
+    int sa = signum(a.num);
+    int sb = signum(b.num);
+    if (sa != sb || sa == 0) {
+        return sa < sb ? -1 : sa > sb ? 1 : 0;
+    }
+    if (a.den == b.den) {
+        return compare(a.num.view(), b.num.view());
+    }
+    big_integer lhs = a.num * b.den;
+    big_integer rhs = b.num * a.den;
+    return compare(lhs.view(), rhs.view());
+}
+
+bool operator==(big_rational const& a, big_rational const& b) {
+    if (a.reduced && b.reduced) {
+        return a.num == b.num && a.den == b.den;
+    }
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_rational const& a, big_rational const& b) {
+    return !(a == b);
+}
+
+bool operator<(big_rational const& a, big_rational const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_rational const& a, big_rational const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_rational const& a, big_rational const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_rational const& a, big_rational const& b) {
+    return compare(a, b) >= 0;
+}
+
+std::string to_string(big_rational const& a) {
+    big_rational r = a;
+    r.normalize();
+    std::string res = to_string(r.numerator());
+    if (r.denominator() != 1) {
+        res += '/';
+        res += to_string(r.denominator());
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& s, big_rational const& a) {
+    big_rational r = a;
+    r.normalize();
+    s << r.numerator();
+    if (r.denominator() != 1) {
+        s << '/' << r.denominator();
+    }
+    return s;
+}
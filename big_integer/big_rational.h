@@ -0,0 +1,68 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+// Fraction of two big_integers with a positive denominator. Sums leave it
+// out of lowest terms and the gcd is only taken once the denominator has
+// grown well past its size at the last reduction, or on normalize() and
+// output; products cancel across the operands instead, which keeps fractions
+// in lowest terms reduced. Comparisons cross-multiply and never reduce.
+struct big_rational {
+    big_rational();
+    explicit big_rational(big_integer num);
+    // throws std::domain_error when den is zero
+    big_rational(big_integer num, big_integer den);
+
+    // the fraction as stored; in lowest terms after normalize()
+    big_integer const& numerator() const;
+    big_integer const& denominator() const;
+    bool is_normalized() const;
+    big_rational& normalize();
+
+    big_rational& operator+=(big_rational const& rhs);
+    big_rational& operator-=(big_rational const& rhs);
+    big_rational& operator*=(big_rational const& rhs);
+    // throws std::domain_error when rhs is zero
+    big_rational& operator/=(big_rational const& rhs);
+    big_rational& operator+=(big_integer const& rhs);
+    big_rational& operator-=(big_integer const& rhs);
+    big_rational& operator*=(big_integer const& rhs);
+
+    big_rational operator+() const;
+    big_rational operator-() const;
+
+    friend int compare(big_rational const& a, big_rational const& b);
+    friend bool operator==(big_rational const& a, big_rational const& b);
+
+private:
+    void add(big_rational const& rhs, bool subtract);
+    void reduce_if_large();
+
+private:
+    big_integer num;
+    big_integer den{1};
+    // whether num / den is known to be in lowest terms
+    bool reduced{true};
+    // bit length of den when it was last reduced
+    size_t reduced_bits{0};
+};
+
+big_rational operator+(big_rational a, big_rational const& b);
+big_rational operator-(big_rational a, big_rational const& b);
+big_rational operator*(big_rational a, big_rational const& b);
+big_rational operator/(big_rational a, big_rational const& b);
+
+int compare(big_rational const& a, big_rational const& b);
+bool operator==(big_rational const& a, big_rational const& b);
+bool operator!=(big_rational const& a, big_rational const& b);
+bool operator<(big_rational const& a, big_rational const& b);
+bool operator>(big_rational const& a, big_rational const& b);
+bool operator<=(big_rational const& a, big_rational const& b);
+bool operator>=(big_rational const& a, big_rational const& b);
+
+// "num/den" in lowest terms, or just "num" for integers
+std::string to_string(big_rational const& a);
+std::ostream& operator<<(std::ostream& s, big_rational const& a);
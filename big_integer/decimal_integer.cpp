@@ -0,0 +1,260 @@
+#include "decimal_integer.h"
+#include "digit_kernels.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+constexpr size_t CHUNK = 9;
+constexpr uint32_t BASE = DEC[CHUNK];
+
+void trim(std::vector<uint32_t>& limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+int compare_magnitudes(std::vector<uint32_t> const& a,
+                       std::vector<uint32_t> const& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i != 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// a += b; b may be a
+void add_magnitudes(std::vector<uint32_t>& a, std::vector<uint32_t> const& b) {
+    size_t n = std::max(a.size(), b.size());
+    a.resize(n + 1);
+    uint32_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t sum = a[i] + (i < b.size() ? b[i] : 0) + carry;
+        carry = (sum >= BASE ? 1 : 0);
+        a[i] = sum - carry * BASE;
+    }
+    a[n] = carry;
+    trim(a);
+}
+
+// a = a - b, or a = b - a when reversed; the difference must not be negative
+void sub_magnitudes(std::vector<uint32_t>& a, std::vector<uint32_t> const& b,
+                    bool reversed) {
+    size_t n = std::max(a.size(), b.size());
+    a.resize(n);
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = reversed ? (i < b.size() ? b[i] : 0) : a[i];
+        uint32_t y = reversed ? a[i] : (i < b.size() ? b[i] : 0);
+        uint32_t sub = y + borrow;
+        borrow = (x < sub ? 1 : 0);
+        a[i] = x + borrow * BASE - sub;
+    }
+    trim(a);
+}
+
+size_t digit_count(uint32_t value) {
+    size_t res = 1;
+    while (res < CHUNK && value >= DEC[res]) {
+        res++;
+    }
+    return res;
+}
+} // namespace
+
+decimal_integer::decimal_integer() = default;
+
+decimal_integer::decimal_integer(int64_t a) : negative(a < 0) {
+    uint64_t m = a < 0 ? 0 - static_cast<uint64_t>(a) : a;
+    for (; m != 0; m /= BASE) {
+        limbs.push_back(static_cast<uint32_t>(m % BASE));
+    }
+}
+
+decimal_integer::decimal_integer(std::string_view str) {
+    char const* first = str.data();
+    char const* last = first + str.size();
+    if (last - first > 1 && first[0] == '+' && first[1] != '-') {
+        first++;
+    }
+    bool minus = (first != last && *first == '-');
+    if (minus) {
+        first++;
+    }
+    if (first == last || count_digits(first, last) != size_t(last - first)) {
+        throw std::invalid_argument("invalid decimal_integer: " +
+                                    std::string(str));
+    }
+    limbs.reserve((last - first) / CHUNK + 1);
+    for (char const* p = last; p != first;) {
+        size_t len = std::min<size_t>(CHUNK, p - first);
+        p -= len;
+        limbs.push_back(static_cast<uint32_t>(parse_digits(p, len)));
+    }
+    trim(limbs);
+    negative = minus && !limbs.empty();
+}
+
+decimal_integer::decimal_integer(big_integer const& a)
+    : decimal_integer(to_string(a)) {}
+
+big_integer decimal_integer::value() const {
+    return big_integer(to_string(*this));
+}
+
+void decimal_integer::add(decimal_integer const& rhs, bool subtract) {
+    bool rhs_negative = (rhs.negative != subtract);
+    if (negative == rhs_negative) {
+        add_magnitudes(limbs, rhs.limbs);
+        return;
+    }
+    // the result takes the sign of the larger magnitude
+    bool reversed = compare_magnitudes(limbs, rhs.limbs) < 0;
+    sub_magnitudes(limbs, rhs.limbs, reversed);
+    if (reversed) {
+        negative = rhs_negative;
+    }
+    if (limbs.empty()) {
+        negative = false;
+    }
+}
+
+decimal_integer& decimal_integer::operator+=(decimal_integer const& rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+decimal_integer& decimal_integer::operator-=(decimal_integer const& rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+decimal_integer& decimal_integer::operator*=(decimal_integer const& rhs) {
+    if (is_zero() || rhs.is_zero()) {
+        return *this = decimal_integer();
+    }
+    std::vector<uint32_t> res(limbs.size() + rhs.limbs.size());
+    for (size_t i = 0; i < limbs.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.limbs.size(); j++) {
+            // below 10^18 + 2 10^9, far from overflowing
+            uint64_t cur =
+                static_cast<uint64_t>(limbs[i]) * rhs.limbs[j] + res[i + j] +
+                carry;
+            res[i + j] = static_cast<uint32_t>(cur % BASE);
+            carry = cur / BASE;
+        }
+        res[i + rhs.limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    trim(res);
+    negative = (negative != rhs.negative);
+    limbs = std::move(res);
+    return *this;
+}
+
+decimal_integer& decimal_integer::operator*=(uint32_t rhs) {
+    if (rhs == 0) {
+        return *this = decimal_integer();
+    }
+    uint64_t carry = 0;
+    for (uint32_t& limb : limbs) {
+        uint64_t cur = static_cast<uint64_t>(limb) * rhs + carry;
+        limb = static_cast<uint32_t>(cur % BASE);
+        carry = cur / BASE;
+    }
+    for (; carry != 0; carry /= BASE) {
+        limbs.push_back(static_cast<uint32_t>(carry % BASE));
+    }
+    return *this;
+}
+
+decimal_integer decimal_integer::operator+() const {
+    return *this;
+}
+
+decimal_integer decimal_integer::operator-() const {
+    decimal_integer res = *this;
+    res.negative = !res.negative && !res.is_zero();
+    return res;
+}
+
+bool decimal_integer::is_zero() const {
+    return limbs.empty();
+}
+
+decimal_integer operator+(decimal_integer a, decimal_integer const& b) {
+    return a += b;
+}
+
+decimal_integer operator-(decimal_integer a, decimal_integer const& b) {
+    return a -= b;
+}
+
+decimal_integer operator*(decimal_integer a, decimal_integer const& b) {
+    return a *= b;
+}
+
+bool operator==(decimal_integer const& a, decimal_integer const& b) {
+    return a.negative == b.negative && a.limbs == b.limbs;
+}
+
+bool operator!=(decimal_integer const& a, decimal_integer const& b) {
+    return !(a == b);
+}
+
+bool operator<(decimal_integer const& a, decimal_integer const& b) {
+    if (a.negative != b.negative) {
+        return a.negative;
+    }
+    int cmp = compare_magnitudes(a.limbs, b.limbs);
+    return a.negative ? cmp > 0 : cmp < 0;
+}
+
+bool operator>(decimal_integer const& a, decimal_integer const& b) {
+    return b < a;
+}
+
+bool operator<=(decimal_integer const& a, decimal_integer const& b) {
+    return !(b < a);
+}
+
+bool operator>=(decimal_integer const& a, decimal_integer const& b) {
+    return !(a < b);
+}
+
+// every limb but the top one is exactly nine digits, so the length is known
+// up front and the limbs are formatted straight into place
+std::string to_string(decimal_integer const& a) {
+    if (a.is_zero()) {
+        return "0";
+    }
+    size_t top = digit_count(a.limbs.back());
+    size_t i = a.limbs.size() - 1;
+    std::string ans((a.negative ? 1 : 0) + top + i * CHUNK, '\0');
+    char* out = ans.data();
+    if (a.negative) {
+        *out++ = '-';
+    }
+    format_digits(a.limbs.back(), out, top);
+    out += top;
+    // pairs of limbs go through the 18-digit kernel
+    if (i % 2 != 0) {
+        format_digits(a.limbs[--i], out, CHUNK);
+        out += CHUNK;
+    }
+    for (; i != 0; i -= 2) {
+        format_digits(a.limbs[i - 1] * static_cast<uint64_t>(BASE) +
+                          a.limbs[i - 2],
+                      out, 2 * CHUNK);
+        out += 2 * CHUNK;
+    }
+    return ans;
+}
+
+std::ostream& operator<<(std::ostream& s, decimal_integer const& a) {
+    return s << to_string(a);
+}
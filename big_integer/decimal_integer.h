@@ -0,0 +1,59 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Signed integer kept as a magnitude in base 10^9 limbs, for values that are
+// mostly added, scaled and printed. Converting to and from decimal strings
+// takes linear time, as every limb is nine digits; converting to and from
+// big_integer costs a full radix conversion instead.
+struct decimal_integer {
+    decimal_integer();
+    decimal_integer(int64_t a);
+    // throws std::invalid_argument unless str is a whole decimal number
+    explicit decimal_integer(std::string_view str);
+    explicit decimal_integer(big_integer const& a);
+
+    big_integer value() const;
+
+    decimal_integer& operator+=(decimal_integer const& rhs);
+    decimal_integer& operator-=(decimal_integer const& rhs);
+    decimal_integer& operator*=(decimal_integer const& rhs);
+    decimal_integer& operator*=(uint32_t rhs);
+
+    decimal_integer operator+() const;
+    decimal_integer operator-() const;
+
+    bool is_zero() const;
+
+    friend bool operator==(decimal_integer const& a, decimal_integer const& b);
+    friend bool operator<(decimal_integer const& a, decimal_integer const& b);
+
+    friend std::string to_string(decimal_integer const& a);
+
+private:
+    void add(decimal_integer const& rhs, bool subtract);
+
+private:
+    bool negative{false};
+    // least significant first, without zero limbs on top
+    std::vector<uint32_t> limbs;
+};
+
+decimal_integer operator+(decimal_integer a, decimal_integer const& b);
+decimal_integer operator-(decimal_integer a, decimal_integer const& b);
+decimal_integer operator*(decimal_integer a, decimal_integer const& b);
+
+bool operator==(decimal_integer const& a, decimal_integer const& b);
+bool operator!=(decimal_integer const& a, decimal_integer const& b);
+bool operator<(decimal_integer const& a, decimal_integer const& b);
+bool operator>(decimal_integer const& a, decimal_integer const& b);
+bool operator<=(decimal_integer const& a, decimal_integer const& b);
+bool operator>=(decimal_integer const& a, decimal_integer const& b);
+
+std::string to_string(decimal_integer const& a);
+std::ostream& operator<<(std::ostream& s, decimal_integer const& a);
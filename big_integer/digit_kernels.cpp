@@ -0,0 +1,106 @@
+#include "digit_kernels.h"
+#if defined(__SSE2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace {
+#ifdef __SSE2__
+bool all_digits_16(char const* str) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(str));
+    __m128i d = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    __m128i nine = _mm_set1_epi8(9);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine)) ==
+           0xffff;
+}
+#endif
+
+uint64_t parse_16(char const* str) {
+#ifdef __SSE4_1__
+    __m128i d = _mm_sub_epi8(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(str)),
+        _mm_set1_epi8('0'));
+    // pairs, then quads, then octets of digits
+    __m128i t = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                   10, 1, 10, 1, 10, 1, 10, 1));
+    t = _mm_madd_epi16(t, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    t = _mm_packus_epi32(t, t);
+    t = _mm_madd_epi16(
+        t, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    uint64_t hi = static_cast<uint32_t>(_mm_cvtsi128_si32(t));
+    uint64_t lo = static_cast<uint32_t>(_mm_extract_epi32(t, 1));
+    return hi * DEC[8] + lo;
+#else
+    uint64_t res = 0;
+    for (size_t i = 0; i < 16; i++) {
+        res = res * 10 + (str[i] - '0');
+    }
+    return res;
+#endif
+}
+
+// value < 10^16 as 16 digits
+void format_16(uint64_t value, char* out) {
+    uint32_t hi = static_cast<uint32_t>(value / DEC[8]);
+    uint32_t lo = static_cast<uint32_t>(value % DEC[8]);
+#ifdef __SSE2__
+    // four groups of four digits, split into pairs, then into single digits;
+    // the divisions by 100 and 10 are multiplications by reciprocals
+    __m128i x = _mm_setr_epi16(static_cast<short>(hi / DEC[4]),
+                               static_cast<short>(hi % DEC[4]),
+                               static_cast<short>(lo / DEC[4]),
+                               static_cast<short>(lo % DEC[4]), 0, 0, 0, 0);
+    __m128i q = _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(5243)), 3);
+    __m128i r = _mm_sub_epi16(x, _mm_mullo_epi16(q, _mm_set1_epi16(100)));
+    __m128i t = _mm_unpacklo_epi16(q, r);
+    __m128i tens = _mm_srli_epi16(_mm_mullo_epi16(t, _mm_set1_epi16(103)), 10);
+    __m128i ones = _mm_sub_epi16(t, _mm_mullo_epi16(tens, _mm_set1_epi16(10)));
+    __m128i digits = _mm_or_si128(tens, _mm_slli_epi16(ones, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_add_epi8(digits, _mm_set1_epi8('0')));
+#else
+    for (size_t i = 8; i != 0; i--) {
+        out[i - 1] = static_cast<char>('0' + hi % 10);
+        out[i + 7] = static_cast<char>('0' + lo % 10);
+        hi /= 10;
+        lo /= 10;
+    }
+#endif
+}
+} // namespace
+
+size_t count_digits(char const* first, char const* last) {
+    char const* p = first;
+#ifdef __SSE2__
+    while (last - p >= 16 && all_digits_16(p)) {
+        p += 16;
+    }
+#endif
+    while (p != last && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p - first;
+}
+
+uint64_t parse_digits(char const* str, size_t len) {
+    uint64_t res = 0;
+    size_t head = len >= 16 ? len - 16 : len;
+    for (size_t i = 0; i < head; i++) {
+        res = res * 10 + (str[i] - '0');
+    }
+    if (len >= 16) {
+        res = res * DEC16 + parse_16(str + head);
+    }
+    return res;
+}
+
+void format_digits(uint64_t value, char* out, size_t len) {
+    if (len >= 16) {
+        format_16(value % DEC16, out + len - 16);
+        value /= DEC16;
+        len -= 16;
+    }
+    for (size_t i = len; i != 0; i--) {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
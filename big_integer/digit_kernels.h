@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+constexpr std::array<uint32_t, 10> DEC{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+constexpr uint64_t DEC16 = 10000000000000000;
+constexpr uint64_t DEC19 = 10000000000000000000u;
+
+// length of the run of decimal digits at the start of [first, last)
+size_t count_digits(char const* first, char const* last);
+
+// value of the len <= 19 decimal digits at str, which must all be valid
+uint64_t parse_digits(char const* str, size_t len);
+
+// writes value < 10^len as exactly len <= 19 digits, zero padded
+void format_digits(uint64_t value, char* out, size_t len);
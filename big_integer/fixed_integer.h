@@ -0,0 +1,391 @@
+#pragma once
+
+#include "big_integer.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Integer of exactly Bits bits with inline limbs. Arithmetic wraps modulo
+// 2^Bits; signed values use two's complement, division truncates towards
+// zero and throws std::domain_error on a zero divisor like big_integer.
+template <size_t Bits, bool Signed = true>
+struct fixed_integer {
+    static_assert(Bits % 32 == 0 && Bits != 0,
+                  "fixed_integer needs a positive multiple of 32 bits");
+    static constexpr size_t N = Bits / 32;
+
+    constexpr fixed_integer() = default;
+
+    template <typename T,
+              typename = std::enable_if_t<std::is_integral<T>::value>>
+    constexpr fixed_integer(T a) {
+        uint64_t value = static_cast<uint64_t>(a);
+        uint32_t fill = 0;
+        if constexpr (std::is_signed<T>::value) {
+            fill = a < 0 ? UINT32_MAX : 0;
+        }
+        for (size_t i = 0; i < N; i++) {
+            digits[i] =
+                i < 2 ? static_cast<uint32_t>(value >> (32 * i)) : fill;
+        }
+    }
+
+    explicit fixed_integer(big_integer const& a) {
+        for (size_t i = 0; i < N; i++) {
+            digits[i] = a.get_digit(i);
+        }
+    }
+
+    explicit fixed_integer(std::string const& str)
+        : fixed_integer(big_integer(str)) {}
+
+    explicit operator big_integer() const {
+        big_integer res;
+        for (size_t i = N; i != 0; i--) {
+            res <<= 32;
+            res += digits[i - 1];
+        }
+        if (is_negative()) {
+            res -= big_integer(1) << static_cast<int>(Bits);
+        }
+        return res;
+    }
+
+    constexpr fixed_integer& operator+=(fixed_integer const& rhs) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < N; i++) {
+            uint64_t sum = carry + digits[i] + rhs.digits[i];
+            digits[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator-=(fixed_integer const& rhs) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < N; i++) {
+            uint64_t diff = static_cast<uint64_t>(digits[i]) - rhs.digits[i] -
+                            borrow;
+            digits[i] = static_cast<uint32_t>(diff);
+            borrow = (diff >> 32) & 1;
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator*=(fixed_integer const& rhs) {
+        std::array<uint32_t, N> res{};
+        for (size_t i = 0; i < N; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < N; j++) {
+                uint64_t cur =
+                    static_cast<uint64_t>(digits[i]) * rhs.digits[j] +
+                    res[i + j] + carry;
+                res[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+        }
+        digits = res;
+        return *this;
+    }
+
+    constexpr fixed_integer& operator/=(fixed_integer const& rhs) {
+        fixed_integer mod;
+        div_and_mod(*this, rhs, *this, mod);
+        return *this;
+    }
+
+    constexpr fixed_integer& operator%=(fixed_integer const& rhs) {
+        fixed_integer div;
+        div_and_mod(*this, rhs, div, *this);
+        return *this;
+    }
+
+    constexpr fixed_integer& operator&=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < N; i++) {
+            digits[i] &= rhs.digits[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator|=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < N; i++) {
+            digits[i] |= rhs.digits[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator^=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < N; i++) {
+            digits[i] ^= rhs.digits[i];
+        }
+        return *this;
+    }
+
+    // a negative count shifts the other way; its magnitude is taken in
+    // unsigned arithmetic, as -INT_MIN does not fit in an int
+    constexpr fixed_integer& operator<<=(int rhs) {
+        if (rhs < 0) {
+            return shift_right(0u - static_cast<unsigned>(rhs));
+        }
+        return shift_left(static_cast<size_t>(rhs));
+    }
+
+    constexpr fixed_integer& operator>>=(int rhs) {
+        if (rhs < 0) {
+            return shift_left(0u - static_cast<unsigned>(rhs));
+        }
+        return shift_right(static_cast<size_t>(rhs));
+    }
+
+    constexpr fixed_integer operator+() const {
+        return *this;
+    }
+
+    constexpr fixed_integer operator-() const {
+        return ~*this + 1;
+    }
+
+    constexpr fixed_integer operator~() const {
+        fixed_integer res;
+        for (size_t i = 0; i < N; i++) {
+            res.digits[i] = ~digits[i];
+        }
+        return res;
+    }
+
+    constexpr fixed_integer& operator++() {
+        return *this += 1;
+    }
+
+    constexpr fixed_integer operator++(int) {
+        fixed_integer cur = *this;
+        *this += 1;
+        return cur;
+    }
+
+    constexpr fixed_integer& operator--() {
+        return *this -= 1;
+    }
+
+    constexpr fixed_integer operator--(int) {
+        fixed_integer cur = *this;
+        *this -= 1;
+        return cur;
+    }
+
+    constexpr fixed_integer abs() const {
+        return is_negative() ? -*this : *this;
+    }
+
+    constexpr uint32_t get_digit(size_t ind) const {
+        if (ind < N) {
+            return digits[ind];
+        }
+        return is_negative() ? UINT32_MAX : 0;
+    }
+
+    constexpr bool is_zero() const {
+        for (size_t i = 0; i < N; i++) {
+            if (digits[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool is_negative() const {
+        return Signed && (digits[N - 1] >> 31) != 0;
+    }
+
+    friend constexpr fixed_integer operator+(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a += b;
+    }
+    friend constexpr fixed_integer operator-(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a -= b;
+    }
+    friend constexpr fixed_integer operator*(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a *= b;
+    }
+    friend constexpr fixed_integer operator/(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a /= b;
+    }
+    friend constexpr fixed_integer operator%(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a %= b;
+    }
+    friend constexpr fixed_integer operator&(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a &= b;
+    }
+    friend constexpr fixed_integer operator|(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a |= b;
+    }
+    friend constexpr fixed_integer operator^(fixed_integer a,
+                                             fixed_integer const& b) {
+        return a ^= b;
+    }
+    friend constexpr fixed_integer operator<<(fixed_integer a, int b) {
+        return a <<= b;
+    }
+    friend constexpr fixed_integer operator>>(fixed_integer a, int b) {
+        return a >>= b;
+    }
+
+    friend constexpr bool operator==(fixed_integer const& a,
+                                     fixed_integer const& b) {
+        for (size_t i = 0; i < N; i++) {
+            if (a.digits[i] != b.digits[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    friend constexpr bool operator!=(fixed_integer const& a,
+                                     fixed_integer const& b) {
+        return !(a == b);
+    }
+    friend constexpr bool operator<(fixed_integer const& a,
+                                    fixed_integer const& b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative();
+        }
+        for (size_t i = N; i != 0; i--) {
+            if (a.digits[i - 1] != b.digits[i - 1]) {
+                return a.digits[i - 1] < b.digits[i - 1];
+            }
+        }
+        return false;
+    }
+    friend constexpr bool operator>(fixed_integer const& a,
+                                    fixed_integer const& b) {
+        return b < a;
+    }
+    friend constexpr bool operator<=(fixed_integer const& a,
+                                     fixed_integer const& b) {
+        return !(b < a);
+    }
+    friend constexpr bool operator>=(fixed_integer const& a,
+                                     fixed_integer const& b) {
+        return !(a < b);
+    }
+
+    friend std::string to_string(fixed_integer const& a) {
+        return to_string(static_cast<big_integer>(a));
+    }
+    friend std::ostream& operator<<(std::ostream& s, fixed_integer const& a) {
+        return s << static_cast<big_integer>(a);
+    }
+
+private:
+    // unsigned long division of a by b, a single-limb divisor takes the
+    // short path
+    static constexpr void divide_unsigned(fixed_integer const& a,
+                                          fixed_integer const& b,
+                                          fixed_integer& div,
+                                          fixed_integer& mod) {
+        fixed_integer q;
+        fixed_integer r;
+        size_t b_size = N;
+        while (b_size != 0 && b.digits[b_size - 1] == 0) {
+            b_size--;
+        }
+        if (b_size == 1) {
+            uint64_t rest = 0;
+            for (size_t i = N; i != 0; i--) {
+                uint64_t cur = (rest << 32) | a.digits[i - 1];
+                q.digits[i - 1] = static_cast<uint32_t>(cur / b.digits[0]);
+                rest = cur % b.digits[0];
+            }
+            r.digits[0] = static_cast<uint32_t>(rest);
+        } else {
+            for (size_t bit = Bits; bit != 0; bit--) {
+                size_t k = bit - 1;
+                bool top = (r.digits[N - 1] >> 31) != 0;
+                r.shift_left_one();
+                r.digits[0] |= (a.digits[k / 32] >> (k % 32)) & 1;
+                if (top || !unsigned_less(r, b)) {
+                    r -= b;
+                    q.digits[k / 32] |= 1u << (k % 32);
+                }
+            }
+        }
+        div = q;
+        mod = r;
+    }
+
+    static constexpr void div_and_mod(fixed_integer const& a,
+                                      fixed_integer const& b,
+                                      fixed_integer& div, fixed_integer& mod) {
+        if (b.is_zero()) {
+            throw std::domain_error("fixed_integer division by zero");
+        }
+        bool a_neg = a.is_negative();
+        bool b_neg = b.is_negative();
+        fixed_integer q;
+        fixed_integer r;
+        divide_unsigned(a_neg ? -a : a, b_neg ? -b : b, q, r);
+        div = a_neg != b_neg ? -q : q;
+        mod = a_neg ? -r : r;
+    }
+
+    static constexpr bool unsigned_less(fixed_integer const& a,
+                                        fixed_integer const& b) {
+        for (size_t i = N; i != 0; i--) {
+            if (a.digits[i - 1] != b.digits[i - 1]) {
+                return a.digits[i - 1] < b.digits[i - 1];
+            }
+        }
+        return false;
+    }
+
+    constexpr fixed_integer& shift_left(size_t count) {
+        size_t words = count / 32;
+        uint32_t bits = count % 32;
+        for (size_t i = N; i != 0; i--) {
+            size_t j = i - 1;
+            uint32_t hi = j >= words ? digits[j - words] : 0;
+            uint32_t lo = j >= words + 1 ? digits[j - words - 1] : 0;
+            digits[j] = bits == 0 ? hi : (hi << bits) | (lo >> (32 - bits));
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& shift_right(size_t count) {
+        uint32_t fill = is_negative() ? UINT32_MAX : 0;
+        size_t words = std::min(count / 32, N);
+        uint32_t bits = count % 32;
+        for (size_t i = 0; i < N; i++) {
+            uint32_t lo = i + words < N ? digits[i + words] : fill;
+            uint32_t hi = i + words + 1 < N ? digits[i + words + 1] : fill;
+            digits[i] = bits == 0 ? lo : (lo >> bits) | (hi << (32 - bits));
+        }
+        return *this;
+    }
+
+    constexpr void shift_left_one() {
+        for (size_t i = N; i != 0; i--) {
+            uint32_t lo = i >= 2 ? digits[i - 2] >> 31 : 0;
+            digits[i - 1] = (digits[i - 1] << 1) | lo;
+        }
+    }
+
+private:
+    std::array<uint32_t, N> digits{};
+};
+
+using int128_fixed = fixed_integer<128>;
+using uint128_fixed = fixed_integer<128, false>;
+using int256_fixed = fixed_integer<256>;
+using uint256_fixed = fixed_integer<256, false>;
+using int512_fixed = fixed_integer<512>;
+using uint512_fixed = fixed_integer<512, false>;
@@ -0,0 +1,119 @@
+#include "limb_kernels.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+constexpr uint32_t CAPACITY = 32;
+
+// below this many limbs in the shorter operand the schoolbook product wins;
+// benchmarks.cpp measures the crossover, builds can override it to retune
+#ifndef BIG_INTEGER_KARATSUBA_THRESHOLD
+#define BIG_INTEGER_KARATSUBA_THRESHOLD 32
+#endif
+constexpr size_t KARATSUBA_THRESHOLD = BIG_INTEGER_KARATSUBA_THRESHOLD;
+static_assert(KARATSUBA_THRESHOLD >= 4, "Karatsuba needs a few limbs a half");
+
+// out[0, n + m) = a[0, n) * b[0, m), out must be zero-filled
+void mul_basecase(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+                  uint32_t* out) {
+    for (size_t i = 0; i < m; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; j++) {
+            uint64_t cur =
+                static_cast<uint64_t>(a[j]) * b[i] + carry + out[i + j];
+            out[i + j] = (cur & UINT32_MAX);
+            carry = (cur >> CAPACITY);
+        }
+        out[i + n] = carry;
+    }
+}
+
+// m <= n < 2 m: with a = a1 B^h + a0 and b = b1 B^h + b0,
+// a b = z2 B^2h + ((a0 + a1) (b0 + b1) - z0 - z2) B^h + z0
+// for z0 = a0 b0 and z2 = a1 b1
+void mul_karatsuba(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+                   uint32_t* out, uint32_t* ws) {
+    size_t h = n / 2;
+    mul_serial(a, h, b, h, out, ws);
+    mul_serial(a + h, n - h, b + h, m - h, out + 2 * h, ws);
+
+    size_t la = n - h + 1;
+    size_t lb = std::max(h, m - h) + 1;
+    uint32_t* sa = ws;
+    uint32_t* sb = sa + la;
+    uint32_t* mid = sb + lb;
+    std::fill(sa, mid + la + lb, 0);
+    std::copy(a + h, a + n, sa);
+    add_limbs(sa, la, a, h);
+    std::copy(b, b + h, sb);
+    add_limbs(sb, lb, b + h, m - h);
+    mul_serial(sa, la, sb, lb, mid, mid + la + lb);
+    sub_limbs(mid, la + lb, out, 2 * h);
+    sub_limbs(mid, la + lb, out + 2 * h, n + m - 2 * h);
+    // a0 b1 + a1 b0 < B^(n + m - h), so any limb of mid above that is zero
+    add_limbs(out + h, n + m - h, mid, std::min(la + lb, n + m - h));
+}
+
+// n >= 2 m: a is cut into pieces of m limbs, each multiplied by b with the
+// balanced algorithms and added in at its offset
+void mul_unbalanced(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+                    uint32_t* out, uint32_t* ws) {
+    uint32_t* part = ws;
+    for (size_t lo = 0; lo < n; lo += m) {
+        size_t len = std::min(m, n - lo);
+        std::fill(part, part + len + m, 0);
+        mul_serial(a + lo, len, b, m, part, part + 2 * m);
+        add_limbs(out + lo, n + m - lo, part, len + m);
+    }
+}
+} // namespace
+
+void add_limbs(uint32_t* dst, size_t n, uint32_t const* src, size_t len) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < len; i++) {
+        uint64_t sum = carry + dst[i] + src[i];
+        dst[i] = (sum & UINT32_MAX);
+        carry = (sum >> CAPACITY);
+    }
+    for (; carry != 0 && i < n; i++) {
+        uint64_t sum = carry + dst[i];
+        dst[i] = (sum & UINT32_MAX);
+        carry = (sum >> CAPACITY);
+    }
+}
+
+void sub_limbs(uint32_t* dst, size_t n, uint32_t const* src, size_t len) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < len; i++) {
+        uint64_t diff = uint64_t(dst[i]) - src[i] - borrow;
+        dst[i] = (diff & UINT32_MAX);
+        borrow = (diff >> CAPACITY) & 1;
+    }
+    for (; borrow != 0 && i < n; i++) {
+        borrow = (dst[i] == 0 ? 1 : 0);
+        dst[i]--;
+    }
+}
+
+// a Karatsuba level on n < 2 m limbs takes about 2 n for its sums and their
+// product and hands the rest to the next level
+size_t mul_space(size_t m) {
+    return 8 * m + 256;
+}
+
+void mul_serial(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+                uint32_t* out, uint32_t* ws) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m < KARATSUBA_THRESHOLD) {
+        mul_basecase(a, n, b, m, out);
+    } else if (n >= 2 * m) {
+        mul_unbalanced(a, n, b, m, out, ws);
+    } else {
+        mul_karatsuba(a, n, b, m, out, ws);
+    }
+}
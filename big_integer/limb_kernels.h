@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Unsigned arithmetic on little-endian arrays of 32-bit limbs, shared by
+// big_integer and the types that keep their limbs elsewhere.
+
+// dst[0, n) += src[0, len), the carry out of dst[n - 1] is dropped
+void add_limbs(uint32_t* dst, size_t n, uint32_t const* src, size_t len);
+
+// dst[0, n) -= src[0, len) for dst >= src
+void sub_limbs(uint32_t* dst, size_t n, uint32_t const* src, size_t len);
+
+// workspace limbs mul_serial needs when the shorter operand has m limbs
+size_t mul_space(size_t m);
+
+// out[0, n + m) = a[0, n) * b[0, m) on the calling thread, by the schoolbook
+// method, Karatsuba or, for operands of very different lengths, balanced
+// pieces; out must be zero-filled, must not overlap the operands, and ws
+// must hold mul_space(min(n, m)) limbs
+void mul_serial(uint32_t const* a, size_t n, uint32_t const* b, size_t m,
+                uint32_t* out, uint32_t* ws);
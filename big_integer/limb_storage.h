@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+// limbs of a big_integer and the temporaries of its operations
+using limb_vector = std::pmr::vector<uint32_t>;
+
+// Limb buffer of a big_integer with the part of the vector interface the
+// library needs. Built with BIG_INTEGER_COW, copies within one memory resource
+// share a reference counted buffer and every non-const member first gives the
+// object a buffer of its own, so a copy costs O(1) and only its first mutation
+// pays for the limbs. Const members never write, so any number of threads may
+// read values that share a buffer while others modify their own copies. A
+// buffer always lives in the resource of the objects sharing it; copies into
+// another resource are deep, as they are for std::pmr::vector.
+class limb_storage {
+public:
+    explicit limb_storage(std::pmr::memory_resource* r)
+#ifdef BIG_INTEGER_COW
+        : res(r) {
+    }
+#else
+        : limbs(r) {
+    }
+#endif
+
+    limb_storage(limb_vector&& limbs, std::pmr::memory_resource* r)
+#ifdef BIG_INTEGER_COW
+        : shared(make_block(limb_vector(std::move(limbs), r))), res(r) {
+    }
+#else
+        : limbs(std::move(limbs), r) {
+    }
+#endif
+
+    limb_storage(std::initializer_list<uint32_t> init,
+                 std::pmr::memory_resource* r)
+        : limb_storage(limb_vector(init, r), r) {}
+
+    limb_storage(uint32_t const* first, uint32_t const* last,
+                 std::pmr::memory_resource* r)
+        : limb_storage(limb_vector(first, last, r), r) {}
+
+    limb_storage(limb_storage const& other, std::pmr::memory_resource* r)
+#ifdef BIG_INTEGER_COW
+        : res(r) {
+        share(other);
+    }
+#else
+        : limbs(other.limbs, r) {
+    }
+#endif
+
+    limb_storage(limb_storage&& other) noexcept
+#ifdef BIG_INTEGER_COW
+        : shared(other.shared), res(other.res) {
+        other.shared = nullptr;
+    }
+#else
+        : limbs(std::move(other.limbs)) {
+    }
+#endif
+
+    limb_storage& operator=(limb_storage const& other) {
+#ifdef BIG_INTEGER_COW
+        if (shared != other.shared) {
+            release();
+            shared = nullptr;
+            share(other);
+        }
+#else
+        limbs = other.limbs;
+#endif
+        return *this;
+    }
+
+    limb_storage& operator=(limb_storage&& other) {
+#ifdef BIG_INTEGER_COW
+        if (this != &other && res != other.res) {
+            *this = other;
+        } else if (this != &other) {
+            release();
+            shared = other.shared;
+            other.shared = nullptr;
+        }
+#else
+        limbs = std::move(other.limbs);
+#endif
+        return *this;
+    }
+
+    ~limb_storage() {
+#ifdef BIG_INTEGER_COW
+        release();
+#endif
+    }
+
+    limb_vector const& get() const {
+#ifdef BIG_INTEGER_COW
+        if (shared == nullptr) {
+            static limb_vector const empty;
+            return empty;
+        }
+        return shared->limbs;
+#else
+        return limbs;
+#endif
+    }
+
+    limb_vector& mut() {
+#ifdef BIG_INTEGER_COW
+        if (shared == nullptr ||
+            shared->refs.load(std::memory_order_acquire) != 1) {
+            block* own = make_block(limb_vector(get(), res));
+            release();
+            shared = own;
+        }
+        return shared->limbs;
+#else
+        return limbs;
+#endif
+    }
+
+    size_t size() const {
+        return get().size();
+    }
+    bool empty() const {
+        return get().empty();
+    }
+    uint32_t const* data() const {
+        return get().data();
+    }
+    uint32_t operator[](size_t i) const {
+        return get()[i];
+    }
+    uint32_t back() const {
+        return get().back();
+    }
+    limb_vector::const_iterator begin() const {
+        return get().begin();
+    }
+    limb_vector::const_iterator end() const {
+        return get().end();
+    }
+
+    uint32_t* data() {
+        return mut().data();
+    }
+    uint32_t& operator[](size_t i) {
+        return mut()[i];
+    }
+    limb_vector::iterator begin() {
+        return mut().begin();
+    }
+    limb_vector::iterator end() {
+        return mut().end();
+    }
+    void resize(size_t n, uint32_t fill = 0) {
+        mut().resize(n, fill);
+    }
+    void push_back(uint32_t x) {
+        mut().push_back(x);
+    }
+    void pop_back() {
+        mut().pop_back();
+    }
+    void clear() {
+#ifdef BIG_INTEGER_COW
+        // no point in copying limbs that are about to go
+        if (shared != nullptr &&
+            shared->refs.load(std::memory_order_acquire) != 1) {
+            release();
+            shared = nullptr;
+            return;
+        }
+#endif
+        mut().clear();
+    }
+
+    // where the limbs of *this are allocated from once it owns them
+    std::pmr::memory_resource* resource() const {
+#ifdef BIG_INTEGER_COW
+        return res;
+#else
+        return limbs.get_allocator().resource();
+#endif
+    }
+
+    // each side keeps its resource; vector::swap needs equal allocators, so
+    // limbs in different resources are exchanged through moves, which copy
+    void swap(limb_storage& other) {
+#ifdef BIG_INTEGER_COW
+        if (res == other.res) {
+            std::swap(shared, other.shared);
+        } else {
+            limb_storage tmp(*this, other.res);
+            *this = other;
+            other = std::move(tmp);
+        }
+#else
+        if (limbs.get_allocator() == other.limbs.get_allocator()) {
+            limbs.swap(other.limbs);
+        } else {
+            limb_vector tmp(std::move(limbs), other.limbs.get_allocator());
+            limbs = std::move(other.limbs);
+            other.limbs = std::move(tmp);
+        }
+#endif
+    }
+
+private:
+#ifdef BIG_INTEGER_COW
+    struct block {
+        explicit block(limb_vector&& limbs) : limbs(std::move(limbs)) {}
+
+        std::atomic<size_t> refs{1};
+        limb_vector limbs;
+    };
+
+    // the block lives in the same resource as its limbs
+    static block* make_block(limb_vector&& limbs) {
+        std::pmr::memory_resource* r = limbs.get_allocator().resource();
+        void* p = r->allocate(sizeof(block), alignof(block));
+        return new (p) block(std::move(limbs));
+    }
+
+    // *this has no buffer yet
+    void share(limb_storage const& other) {
+        if (other.shared == nullptr) {
+            return;
+        }
+        if (other.res == res) {
+            shared = other.shared;
+            shared->refs.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            shared = make_block(limb_vector(other.get(), res));
+        }
+    }
+
+    void release() {
+        if (shared != nullptr &&
+            shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::pmr::memory_resource* r =
+                shared->limbs.get_allocator().resource();
+            shared->~block();
+            r->deallocate(shared, sizeof(block), alignof(block));
+        }
+    }
+
+    block* shared{nullptr};
+    std::pmr::memory_resource* res;
+#else
+    limb_vector limbs;
+#endif
+};
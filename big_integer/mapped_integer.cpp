@@ -0,0 +1,662 @@
+#include "mapped_integer.h"
+#include "digit_kernels.h"
+#include "limb_kernels.h"
+#include "serialization.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+// version byte, ten varint bytes and one byte of padding
+constexpr size_t HEADER = 12;
+
+std::atomic<size_t> window_setting{mapped_integer::WINDOW_LIMBS};
+
+[[noreturn]] void fail(std::string const& what) {
+    throw std::system_error(errno, std::generic_category(),
+                            "mapped_integer: " + what);
+}
+
+char* map_file(int fd, size_t bytes, bool writable) {
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        fail("mmap");
+    }
+    return static_cast<char*>(p);
+}
+
+// changes the size of the file behind data and maps it again
+void resize_file(int fd, char*& data, size_t& bytes, size_t new_bytes) {
+    if (new_bytes == bytes) {
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(new_bytes)) != 0) {
+        fail("ftruncate");
+    }
+    char* p = map_file(fd, new_bytes, true);
+    munmap(data, bytes);
+    data = p;
+    bytes = new_bytes;
+}
+
+// drops the pages that lie wholly inside [first, last) from the process,
+// their contents stay in the file
+void release(void const* first, void const* last) {
+#ifdef MADV_DONTNEED
+    static uintptr_t const page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t a = (reinterpret_cast<uintptr_t>(first) + page - 1) & ~(page - 1);
+    uintptr_t b = reinterpret_cast<uintptr_t>(last) & ~(page - 1);
+    if (a < b) {
+        madvise(reinterpret_cast<void*>(a), b - a, MADV_DONTNEED);
+    }
+#else
+    (void)first;
+    (void)last;
+#endif
+}
+
+// unlinked file of 32-bit words next to the integer's own file
+struct scratch_file {
+    scratch_file() = default;
+    scratch_file(scratch_file const& other) = delete;
+    scratch_file& operator=(scratch_file const& other) = delete;
+    ~scratch_file() {
+        if (data != nullptr) {
+            munmap(data, bytes);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void open(std::string const& near, size_t words) {
+        std::string name = near + ".XXXXXX";
+        fd = mkstemp(&name[0]);
+        if (fd < 0) {
+            fail("mkstemp " + name);
+        }
+        unlink(name.c_str());
+        bytes = 4 * words;
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            fail("ftruncate");
+        }
+        data = map_file(fd, bytes, true);
+    }
+
+    uint32_t* words() const {
+        return reinterpret_cast<uint32_t*>(data);
+    }
+
+    int fd{-1};
+    char* data{nullptr};
+    size_t bytes{0};
+};
+
+// zero-filled limbs, on the heap while they fit in a window and in a
+// scratch file next to the integer's own file beyond that
+class limb_buffer {
+public:
+    limb_buffer() = default;
+
+    limb_buffer(std::string const& near, size_t words) : words(words) {
+        if (words > mapped_integer::window_limbs()) {
+            file = std::make_unique<scratch_file>();
+            file->open(near, words);
+            ptr = file->words();
+        } else {
+            heap.assign(words, 0);
+            ptr = heap.data();
+        }
+    }
+
+    uint32_t* data() const {
+        return ptr;
+    }
+    size_t size() const {
+        return words;
+    }
+
+private:
+    std::vector<uint32_t> heap;
+    std::unique_ptr<scratch_file> file;
+    uint32_t* ptr{nullptr};
+    size_t words{0};
+};
+
+// unsigned value in the low len limbs of a buffer, without zero limbs on top
+struct natural {
+    uint32_t* data() const {
+        return buf.data();
+    }
+
+    limb_buffer buf;
+    size_t len{0};
+};
+
+size_t trimmed(uint32_t const* d, size_t n) {
+    while (n != 0 && d[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+int compare(natural const& a, natural const& b) {
+    if (a.len != b.len) {
+        return a.len < b.len ? -1 : 1;
+    }
+    for (size_t i = a.len; i != 0; i--) {
+        if (a.data()[i - 1] != b.data()[i - 1]) {
+            return a.data()[i - 1] < b.data()[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// writes a magnitude in decimal, most significant digit first, by divide and
+// conquer over the powers P_k = 10^(9 2^k): a value below P_(k + 1) is split
+// into a quotient and a remainder by P_k and both halves are written at level
+// k - 1, the remainder padded to its full 9 2^k digits. The divisions are
+// Barrett reductions with floor(B^(2 s) / P_k) for the s limbs of P_k, each
+// found by Newton's iteration from the square of the one below it, so that
+// every level costs a few multiplications and the whole conversion
+// O(M(n) log n)
+class decimal_writer {
+public:
+    decimal_writer(std::string const& near, std::ostream& out)
+        : near(near), out(out) {}
+
+    ~decimal_writer() {
+        flush();
+    }
+
+    void write(natural m) {
+        natural first = make(1);
+        first.data()[0] = DEC[9];
+        first.len = 1;
+        powers.push_back({std::move(first), natural()});
+        invert(0);
+        for (;;) {
+            natural const& last = powers.back().value;
+            natural next = product(last.data(), last.len, last.data(),
+                                   last.len);
+            if (powers.size() > LEAF_LEVEL && compare(m, next) < 0) {
+                break;
+            }
+            powers.push_back({std::move(next), natural()});
+            invert(powers.size() - 1);
+        }
+        convert(std::move(m), powers.size() - 1, false);
+    }
+
+    void put(char c) {
+        *reserve(1) = c;
+    }
+
+private:
+    // values below P_(LEAF_LEVEL + 1), about 60 limbs, are written by
+    // repeated division by 10^9
+    static constexpr size_t LEAF_LEVEL = 5;
+    static constexpr size_t CHUNK = 9;
+
+    struct power {
+        natural value;
+        // floor(B^(2 s) / value) for the s limbs of value
+        natural inverse;
+    };
+
+    natural make(size_t words) const {
+        return {limb_buffer(near, words), 0};
+    }
+
+    // mul_serial's workspace, kept for the whole conversion
+    uint32_t* workspace(size_t m) {
+        if (ws.size() < mul_space(m)) {
+            ws = limb_buffer(near, mul_space(m));
+        }
+        return ws.data();
+    }
+
+    natural product(uint32_t const* a, size_t n, uint32_t const* b,
+                    size_t m) {
+        natural res = make(n + m);
+        if (n != 0 && m != 0) {
+            mul_serial(a, n, b, m, res.data(), workspace(std::min(n, m)));
+        }
+        res.len = trimmed(res.data(), n + m);
+        return res;
+    }
+
+    static void increment(natural& x, size_t capacity) {
+        uint32_t one = 1;
+        add_limbs(x.data(), capacity, &one, 1);
+        x.len = trimmed(x.data(), capacity);
+    }
+
+    // P_0 = 10^9 is inverted directly. For k > 0, P_k = P_(k - 1)^2 has
+    // s = 2 s' or 2 s' - 1 limbs for the s' limbs of P_(k - 1), so the
+    // square of that inverse, shifted down in the second case, is below
+    // R = B^(2 s) / P_k by a relative error of about 3 B^-s'. A Newton step
+    // x + x (B^(2 s) - P_k x) / B^(2 s) stays below R and squares the
+    // relative error; steps are taken until x = floor(R)
+    void invert(size_t k) {
+        natural const& p = powers[k].value;
+        size_t s = p.len;
+        natural x = make(s + 2);
+        if (k == 0) {
+            uint64_t inverse = UINT64_MAX / DEC[9];
+            x.data()[0] = static_cast<uint32_t>(inverse);
+            x.data()[1] = static_cast<uint32_t>(inverse >> 32);
+        } else {
+            natural const& below = powers[k - 1].inverse;
+            natural square = product(below.data(), below.len, below.data(),
+                                     below.len);
+            size_t shift = s == 2 * powers[k - 1].value.len ? 0 : 2;
+            std::copy(square.data() + shift, square.data() + square.len,
+                      x.data());
+        }
+        x.len = trimmed(x.data(), s + 2);
+        for (;;) {
+            natural px = product(p.data(), p.len, x.data(), x.len);
+            natural e = make(2 * s + 1);
+            e.data()[2 * s] = 1;
+            sub_limbs(e.data(), 2 * s + 1, px.data(), px.len);
+            e.len = trimmed(e.data(), 2 * s + 1);
+            // e = P_k (R - x), so x = floor(R) once e < P_k
+            if (compare(e, p) < 0) {
+                break;
+            }
+            natural step = product(x.data(), x.len, e.data(), e.len);
+            if (step.len > 2 * s) {
+                add_limbs(x.data(), s + 2, step.data() + 2 * s,
+                          step.len - 2 * s);
+                x.len = trimmed(x.data(), s + 2);
+            } else {
+                increment(x, s + 2);
+            }
+        }
+        powers[k].inverse = std::move(x);
+    }
+
+    // x = q P_k + r for x < P_k^2 (HAC 14.42): with the s limbs of P_k,
+    // q' = floor(floor(x / B^(s - 1)) inverse / B^(s + 1)) falls short of q
+    // by at most 2
+    void split(natural x, size_t k, natural& q, natural& r) {
+        natural const& p = powers[k].value;
+        natural const& inverse = powers[k].inverse;
+        size_t s = p.len;
+        if (compare(x, p) < 0) {
+            // padded halves below P_k, whose quotient is 0
+            q = make(0);
+            r = std::move(x);
+            return;
+        }
+        natural q1 = product(x.data() + (s - 1), x.len - (s - 1),
+                             inverse.data(), inverse.len);
+        q = make(s + 2);
+        if (q1.len > s + 1) {
+            std::copy(q1.data() + s + 1, q1.data() + q1.len, q.data());
+        }
+        q.len = trimmed(q.data(), s + 2);
+        q1 = natural();
+        natural t = product(q.data(), q.len, p.data(), p.len);
+        sub_limbs(x.data(), x.len, t.data(), t.len);
+        x.len = trimmed(x.data(), x.len);
+        while (compare(x, p) >= 0) {
+            sub_limbs(x.data(), x.len, p.data(), p.len);
+            x.len = trimmed(x.data(), x.len);
+            increment(q, s + 2);
+        }
+        // the remainder gets a buffer of its own size, as x may be twice as
+        // long and r outlives the conversion of q
+        r = make(s);
+        std::copy(x.data(), x.data() + x.len, r.data());
+        r.len = x.len;
+    }
+
+    // writes x < P_(k + 1), as exactly 9 2^(k + 1) digits when pad is set
+    void convert(natural x, size_t k, bool pad) {
+        if (k <= LEAF_LEVEL) {
+            leaf(x, size_t(2) << k, pad);
+            return;
+        }
+        if (!pad && compare(x, powers[k].value) < 0) {
+            convert(std::move(x), k - 1, false);
+            return;
+        }
+        natural q;
+        natural r;
+        split(std::move(x), k, q, r);
+        convert(std::move(q), k - 1, pad);
+        convert(std::move(r), k - 1, true);
+    }
+
+    void leaf(natural const& x, size_t chunks, bool pad) {
+        std::vector<uint32_t> m(x.data(), x.data() + x.len);
+        std::vector<uint32_t> c;
+        c.reserve(chunks);
+        while (!m.empty()) {
+            uint64_t rem = 0;
+            for (size_t i = m.size(); i != 0; i--) {
+                uint64_t cur = (rem << 32) | m[i - 1];
+                m[i - 1] = static_cast<uint32_t>(cur / DEC[9]);
+                rem = cur % DEC[9];
+            }
+            c.push_back(static_cast<uint32_t>(rem));
+            while (!m.empty() && m.back() == 0) {
+                m.pop_back();
+            }
+        }
+        size_t i = c.size();
+        if (pad) {
+            for (size_t j = c.size(); j < chunks; j++) {
+                format_digits(0, reserve(CHUNK), CHUNK);
+            }
+        } else {
+            // x is never zero here, the caller handles 0
+            char* p = reserve(CHUNK);
+            size_t len = std::to_chars(p, p + CHUNK, c[--i]).ptr - p;
+            used -= CHUNK - len;
+        }
+        for (; i != 0; i--) {
+            format_digits(c[i - 1], reserve(CHUNK), CHUNK);
+        }
+    }
+
+    char* reserve(size_t n) {
+        if (used + n > sizeof(buf)) {
+            flush();
+        }
+        char* res = buf + used;
+        used += n;
+        return res;
+    }
+
+    void flush() {
+        out.write(buf, static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+    std::string const& near;
+    std::ostream& out;
+    std::vector<power> powers;
+    limb_buffer ws;
+    char buf[CHUNK * 1024];
+    size_t used{0};
+};
+} // namespace
+
+size_t mapped_integer::window_limbs() {
+    return window_setting.load(std::memory_order_relaxed);
+}
+
+void mapped_integer::set_window_limbs(size_t limbs) {
+    window_setting.store(std::max<size_t>(limbs, 1), std::memory_order_relaxed);
+}
+
+mapped_integer mapped_integer::create(std::string const& path,
+                                      big_integer_view value) {
+    mapped_integer res;
+    res.path = path;
+    res.writable = true;
+    res.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (res.fd < 0) {
+        fail("open " + path);
+    }
+    res.bytes = HEADER + 4 * value.size;
+    if (ftruncate(res.fd, static_cast<off_t>(res.bytes)) != 0) {
+        fail("ftruncate " + path);
+    }
+    res.data = map_file(res.fd, res.bytes, true);
+    res.offset = HEADER;
+    res.length = value.size;
+    res.sign = value.sign;
+    res.write_header();
+    uint32_t* d = res.limbs();
+    size_t window = window_limbs();
+    for (size_t w = 0; w < value.size; w += window) {
+        size_t end = std::min(value.size, w + window);
+        std::memcpy(d + w, value.digits + w, 4 * (end - w));
+        release(d + w, d + end);
+    }
+    res.attach();
+    return res;
+}
+
+mapped_integer mapped_integer::open(std::string const& path, bool read_only) {
+    mapped_integer res;
+    res.path = path;
+    res.writable = !read_only;
+    res.fd = ::open(path.c_str(), read_only ? O_RDONLY : O_RDWR);
+    if (res.fd < 0) {
+        fail("open " + path);
+    }
+    struct stat st;
+    if (fstat(res.fd, &st) != 0) {
+        fail("fstat " + path);
+    }
+    if (st.st_size == 0) {
+        throw std::invalid_argument("mapped_integer: empty file " + path);
+    }
+    res.bytes = static_cast<size_t>(st.st_size);
+    res.data = map_file(res.fd, res.bytes, res.writable);
+    res.attach();
+    return res;
+}
+
+mapped_integer::mapped_integer(mapped_integer&& other) noexcept {
+    *this = std::move(other);
+}
+
+mapped_integer& mapped_integer::operator=(mapped_integer&& other) noexcept {
+    std::swap(path, other.path);
+    std::swap(fd, other.fd);
+    std::swap(data, other.data);
+    std::swap(bytes, other.bytes);
+    std::swap(offset, other.offset);
+    std::swap(length, other.length);
+    std::swap(sign, other.sign);
+    std::swap(writable, other.writable);
+    return *this;
+}
+
+mapped_integer::~mapped_integer() {
+    if (data != nullptr) {
+        munmap(data, bytes);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+size_t mapped_integer::size() const {
+    return length;
+}
+
+bool mapped_integer::is_negative() const {
+    return sign != 0;
+}
+
+big_integer_view mapped_integer::view() const {
+    return big_integer_view(limbs(), length, sign != 0);
+}
+
+// reads the record at the start of the mapping; a writable file is brought to
+// the fixed-width header of write_header() and cut to the record's length
+void mapped_integer::attach() {
+    big_integer_view v;
+    std::from_chars_result res = deserialize(data, data + bytes, v);
+    if (res.ec == std::errc::not_supported) {
+        throw std::runtime_error("mapped_integer: needs a little-endian host");
+    }
+    if (res.ec != std::errc()) {
+        throw std::invalid_argument("mapped_integer: no valid record in " +
+                                    path);
+    }
+    offset = reinterpret_cast<char const*>(v.digits) - data;
+    length = v.size;
+    sign = v.sign;
+    if (writable) {
+        size_t old = offset;
+        resize(length);
+        if (old != HEADER) {
+            std::memmove(data + HEADER, data + old, 4 * length);
+        }
+        offset = HEADER;
+        write_header();
+    }
+}
+
+// the varint always takes all ten bytes, so the limbs stay at HEADER whatever
+// their number
+void mapped_integer::write_header() {
+    uint64_t x = static_cast<uint64_t>(length) << 1 | (sign & 1);
+    data[0] = static_cast<char>(SERIAL_VERSION);
+    for (size_t i = 0; i < 9; i++) {
+        data[1 + i] = static_cast<char>(((x >> (7 * i)) & 0x7f) | 0x80);
+    }
+    data[10] = static_cast<char>(x >> 63);
+    data[11] = 0;
+}
+
+void mapped_integer::resize(size_t limbs) {
+    resize_file(fd, data, bytes, HEADER + 4 * limbs);
+}
+
+uint32_t* mapped_integer::limbs() const {
+    return reinterpret_cast<uint32_t*>(data + offset);
+}
+
+// drops the redundant sign limbs from the top of the first n limbs
+void mapped_integer::trim(size_t n) {
+    uint32_t const* d = limbs();
+    while (n != 0 && d[n - 1] == sign) {
+        n--;
+    }
+    length = n;
+    resize(n);
+    write_header();
+}
+
+void mapped_integer::add(big_integer_view rhs, bool subtract) {
+    if (!writable) {
+        throw std::logic_error("mapped_integer: opened read-only");
+    }
+    if (rhs.size != 0 && rhs.digits == limbs()) {
+        // a view of *this does not survive the resize below
+        if (subtract) {
+            sign = 0;
+            trim(0);
+        } else {
+            *this *= 2;
+        }
+        return;
+    }
+    size_t old = length;
+    size_t n = std::max(length, rhs.size) + 1;
+    resize(n);
+    uint32_t* d = limbs();
+    uint32_t flip = subtract ? UINT32_MAX : 0;
+    uint64_t carry = subtract ? 1 : 0;
+    size_t window = window_limbs();
+    for (size_t w = 0; w < n; w += window) {
+        size_t end = std::min(n, w + window);
+        for (size_t i = w; i < end; i++) {
+            uint64_t sum = carry + (i < old ? d[i] : sign) +
+                           (rhs.get_digit(i) ^ flip);
+            d[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        release(d + w, d + end);
+    }
+    sign = (d[n - 1] >> 31) != 0 ? UINT32_MAX : 0;
+    trim(n);
+}
+
+mapped_integer& mapped_integer::operator+=(big_integer_view rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+mapped_integer& mapped_integer::operator-=(big_integer_view rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+mapped_integer& mapped_integer::operator+=(big_integer const& rhs) {
+    return *this += rhs.view();
+}
+
+mapped_integer& mapped_integer::operator-=(big_integer const& rhs) {
+    return *this -= rhs.view();
+}
+
+// the low n limbs of the sign-extended value times rhs, which the product
+// always fits in
+mapped_integer& mapped_integer::operator*=(uint32_t rhs) {
+    if (!writable) {
+        throw std::logic_error("mapped_integer: opened read-only");
+    }
+    if (rhs == 0) {
+        sign = 0;
+        trim(0);
+        return *this;
+    }
+    size_t old = length;
+    size_t n = length + 1;
+    resize(n);
+    uint32_t* d = limbs();
+    uint64_t carry = 0;
+    size_t window = window_limbs();
+    for (size_t w = 0; w < n; w += window) {
+        size_t end = std::min(n, w + window);
+        for (size_t i = w; i < end; i++) {
+            uint64_t cur =
+                static_cast<uint64_t>(i < old ? d[i] : sign) * rhs + carry;
+            d[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        release(d + w, d + end);
+    }
+    trim(n);
+    return *this;
+}
+
+void mapped_integer::write_decimal(std::ostream& out) const {
+    if (length == 0 && sign == 0) {
+        out << '0';
+        return;
+    }
+    size_t window = window_limbs();
+    // the magnitude of -2^(32 * length) takes one limb more than the value
+    size_t n = length + 1;
+    natural m{limb_buffer(path, n), 0};
+    uint32_t const* d = limbs();
+    uint64_t carry = sign & 1;
+    for (size_t w = 0; w < n; w += window) {
+        size_t end = std::min(n, w + window);
+        for (size_t i = w; i < end; i++) {
+            uint64_t sum = carry + ((i < length ? d[i] : sign) ^ sign);
+            m.data()[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        release(d + w, d + std::min(length, end));
+    }
+    m.len = trimmed(m.data(), n);
+    decimal_writer writer(path, out);
+    if (sign != 0) {
+        writer.put('-');
+    }
+    writer.write(std::move(m));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Integer kept in a file, in the record format of serialization.h, and mapped
+// into memory, for values too large to hold in RAM. The operations stream over
+// the limbs window_limbs() at a time and drop every finished window from the
+// process, so the memory they use does not grow with the value. Needs a POSIX
+// system with a little-endian CPU.
+struct mapped_integer {
+    static constexpr size_t WINDOW_LIMBS = size_t(1) << 20;
+
+    // limbs streamed at a time by every mapped_integer in the process,
+    // WINDOW_LIMBS by default; a window of 0 is taken as 1
+    static size_t window_limbs();
+    static void set_window_limbs(size_t limbs);
+
+    // creates or truncates the file at path and stores value in it
+    static mapped_integer create(std::string const& path,
+                                 big_integer_view value = {});
+    // opens a file written by create() or by serialize(); throws
+    // std::invalid_argument when it does not start with a valid record
+    static mapped_integer open(std::string const& path, bool read_only = false);
+
+    mapped_integer(mapped_integer const& other) = delete;
+    mapped_integer& operator=(mapped_integer const& other) = delete;
+    mapped_integer(mapped_integer&& other) noexcept;
+    mapped_integer& operator=(mapped_integer&& other) noexcept;
+    ~mapped_integer();
+
+    // number of limbs
+    size_t size() const;
+    bool is_negative() const;
+    // the value in place, valid until *this is modified
+    big_integer_view view() const;
+
+    mapped_integer& operator+=(big_integer_view rhs);
+    mapped_integer& operator-=(big_integer_view rhs);
+    mapped_integer& operator+=(big_integer const& rhs);
+    mapped_integer& operator-=(big_integer const& rhs);
+    mapped_integer& operator*=(uint32_t rhs);
+
+    // writes the value in decimal in O(M(n) log n), dividing it recursively
+    // by the powers 10^(9 2^k) with Newton reciprocals and writing the
+    // digits out most significant first. The powers, their reciprocals and
+    // the parts in flight that are longer than a window go to temporary
+    // files next to this one, which take up to about sixteen times the size
+    // of the value while memory stays within a few windows per level
+    void write_decimal(std::ostream& out) const;
+
+private:
+    mapped_integer() = default;
+    void attach();
+    void resize(size_t limbs);
+    void write_header();
+    void add(big_integer_view rhs, bool subtract);
+    void trim(size_t n);
+    uint32_t* limbs() const;
+
+private:
+    std::string path;
+    int fd{-1};
+    char* data{nullptr};
+    size_t bytes{0};
+    size_t offset{0};
+    size_t length{0};
+    uint32_t sign{0};
+    bool writable{false};
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "big_accumulator.h"
+#include "big_integer.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace parallel_detail {
+constexpr size_t MIN_CHUNK = 64;
+
+// splits [first, last) into at most one chunk per thread of the shared pool,
+// reduces every chunk with reduce(lo, hi) and returns the partial results in
+// chunk order
+template <typename T, typename It, typename Reduce>
+std::vector<T> reduce_chunks(It first, It last, Reduce reduce) {
+    size_t n = std::distance(first, last);
+    thread_pool& pool = thread_pool::shared();
+    size_t parts = std::max<size_t>(1, std::min(pool.size(), n / MIN_CHUNK));
+    std::vector<T> partial(parts);
+    pool.run(parts, [&](size_t i) {
+        partial[i] = reduce(std::next(first, n * i / parts),
+                            std::next(first, n * (i + 1) / parts));
+    });
+    return partial;
+}
+} // namespace parallel_detail
+
+template <typename It>
+big_integer parallel_sum(It first, It last) {
+    std::vector<big_accumulator> partial =
+        parallel_detail::reduce_chunks<big_accumulator>(
+            first, last, [](It lo, It hi) {
+                big_accumulator acc;
+                for (; lo != hi; ++lo) {
+                    acc += *lo;
+                }
+                return acc;
+            });
+    big_accumulator res;
+    for (big_accumulator const& x : partial) {
+        res += x;
+    }
+    return res.value();
+}
+
+template <typename It>
+big_integer parallel_product(It first, It last) {
+    std::vector<big_integer> partial =
+        parallel_detail::reduce_chunks<big_integer>(
+            first, last, [](It lo, It hi) { return product(lo, hi); });
+    return product(partial.begin(), partial.end());
+}
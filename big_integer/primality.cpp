@@ -0,0 +1,344 @@
+#include "primality.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+
+namespace {
+constexpr size_t CAPACITY = 32;
+constexpr uint32_t SMALL_PRIME_LIMIT = 1 << 12;
+// odd candidates sieved at once by next_prime
+constexpr uint32_t SIEVE_WINDOW = 1 << 12;
+// bits of the exponent handled by one table lookup in montgomery::pow
+constexpr size_t POW_WINDOW = 4;
+
+struct small_primes {
+    small_primes() {
+        std::vector<bool> composite(SMALL_PRIME_LIMIT);
+        for (uint32_t p = 2; p < SMALL_PRIME_LIMIT; p++) {
+            if (composite[p]) {
+                continue;
+            }
+            primes.push_back(p);
+            for (uint32_t q = p * p; q < SMALL_PRIME_LIMIT; q += p) {
+                composite[q] = true;
+            }
+        }
+        // a remainder modulo the product of a group yields the remainders
+        // modulo all its primes, so a value is scanned once per group
+        uint64_t product = 1;
+        for (size_t i = 0; i < primes.size(); i++) {
+            if (product * primes[i] > UINT32_MAX) {
+                products.push_back(static_cast<uint32_t>(product));
+                ends.push_back(i);
+                product = 1;
+            }
+            product *= primes[i];
+        }
+        products.push_back(static_cast<uint32_t>(product));
+        ends.push_back(primes.size());
+    }
+
+    std::vector<uint32_t> primes;
+    // products[g] is the product of the primes from ends[g - 1] to ends[g]
+    std::vector<uint32_t> products;
+    std::vector<size_t> ends;
+};
+
+small_primes const& table() {
+    static small_primes const t;
+    return t;
+}
+
+// remainder of the len limbs at digits modulo q
+uint32_t rem_limb(uint32_t const* digits, size_t len, uint32_t q) {
+    uint64_t r = 0;
+    for (size_t i = len; i-- > 0;) {
+        r = ((r << CAPACITY) | digits[i]) % q;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+// out[i] = n mod primes[i] for non-negative n
+void residues(big_integer_view n, std::vector<uint32_t>& out) {
+    small_primes const& t = table();
+    out.resize(t.primes.size());
+    size_t begin = 0;
+    for (size_t g = 0; g < t.products.size(); g++) {
+        uint32_t r = rem_limb(n.digits, n.size, t.products[g]);
+        for (size_t i = begin; i < t.ends[g]; i++) {
+            out[i] = r % t.primes[i];
+        }
+        begin = t.ends[g];
+    }
+}
+
+// Arithmetic modulo an odd n > 1 of k limbs on values x R mod n, with
+// R = 2^(32 k), kept as k limbs; a product costs no division.
+class montgomery {
+public:
+    explicit montgomery(big_integer_view modulus)
+        : n(modulus.digits, modulus.digits + modulus.size), r1(n.size()),
+          r2(n.size()), t(n.size() + 2) {
+        big_integer m(modulus);
+        big_integer r = (big_integer(1) << int(CAPACITY * n.size())) % m;
+        store(r, r1.data());
+        store(r * r % m, r2.data());
+        // Newton iterations double the correct low bits of 1 / n[0], which
+        // start at 3 since every odd x has x * x = 1 mod 8
+        uint32_t x = n[0];
+        for (int i = 0; i < 4; i++) {
+            x *= 2 - n[0] * x;
+        }
+        inv = 0 - x;
+    }
+
+    size_t size() const {
+        return n.size();
+    }
+
+    uint32_t const* one() const {
+        return r1.data();
+    }
+
+    // out = n - a for 0 < a < n
+    void negate(uint32_t const* a, uint32_t* out) const {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n.size(); i++) {
+            uint64_t diff = uint64_t(n[i]) - a[i] - borrow;
+            out[i] = (diff & UINT32_MAX);
+            borrow = (diff >> CAPACITY) & 1;
+        }
+    }
+
+    // the Montgomery form of 0 <= a < n
+    void convert(big_integer const& a, uint32_t* out) {
+        store(a, out);
+        mul(out, r2.data(), out);
+    }
+
+    // out = a * b / R mod n; out may alias a or b
+    void mul(uint32_t const* a, uint32_t const* b, uint32_t* out) {
+        size_t k = n.size();
+        std::fill(t.begin(), t.end(), 0);
+        for (size_t i = 0; i < k; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < k; j++) {
+                uint64_t cur = uint64_t(a[j]) * b[i] + t[j] + carry;
+                t[j] = (cur & UINT32_MAX);
+                carry = (cur >> CAPACITY);
+            }
+            uint64_t top = t[k] + carry;
+            t[k] = (top & UINT32_MAX);
+            t[k + 1] = static_cast<uint32_t>(top >> CAPACITY);
+
+            // adding m * n clears t[0], which the shift by a limb drops
+            uint32_t m = t[0] * inv;
+            carry = (uint64_t(m) * n[0] + t[0]) >> CAPACITY;
+            for (size_t j = 1; j < k; j++) {
+                uint64_t cur = uint64_t(m) * n[j] + t[j] + carry;
+                t[j - 1] = (cur & UINT32_MAX);
+                carry = (cur >> CAPACITY);
+            }
+            top = t[k] + carry;
+            t[k - 1] = (top & UINT32_MAX);
+            t[k] = t[k + 1] + static_cast<uint32_t>(top >> CAPACITY);
+        }
+        // t < 2n, so one subtraction is enough
+        if (t[k] != 0 || !std::lexicographical_compare(
+                             t.rend() - k, t.rend(), n.rbegin(), n.rend())) {
+            uint64_t borrow = 0;
+            for (size_t j = 0; j < k; j++) {
+                uint64_t diff = uint64_t(t[j]) - n[j] - borrow;
+                t[j] = (diff & UINT32_MAX);
+                borrow = (diff >> CAPACITY) & 1;
+            }
+        }
+        std::copy_n(t.begin(), k, out);
+    }
+
+    // out = base^e in Montgomery form for e >= 0; out must not alias base
+    void pow(uint32_t const* base, big_integer_view e, uint32_t* out) {
+        size_t k = n.size();
+        powers.resize(k << POW_WINDOW);
+        std::copy_n(one(), k, powers.data());
+        for (size_t i = 1; i < (size_t(1) << POW_WINDOW); i++) {
+            mul(powers.data() + (i - 1) * k, base, powers.data() + i * k);
+        }
+        std::copy_n(one(), k, out);
+        bool started = false;
+        for (size_t bit = e.size * CAPACITY; bit != 0;) {
+            bit -= POW_WINDOW;
+            size_t digit = (e.digits[bit / CAPACITY] >> (bit % CAPACITY)) &
+                           ((size_t(1) << POW_WINDOW) - 1);
+            if (started) {
+                for (size_t i = 0; i < POW_WINDOW; i++) {
+                    mul(out, out, out);
+                }
+            }
+            if (digit != 0) {
+                mul(out, powers.data() + digit * k, out);
+                started = true;
+            }
+        }
+    }
+
+private:
+    // the limbs of 0 <= a < n, zero padded to k
+    void store(big_integer const& a, uint32_t* out) const {
+        big_integer_view v = a.view();
+        std::copy_n(v.digits, v.size, out);
+        std::fill(out + v.size, out + n.size(), 0);
+    }
+
+private:
+    limb_vector n;
+    limb_vector r1;
+    limb_vector r2;
+    limb_vector t;
+    limb_vector powers;
+    uint32_t inv;
+};
+
+// Miller-Rabin for an odd n above SMALL_PRIME_LIMIT: base 2 and then bases
+// drawn at random from [2, n - 2]
+bool miller_rabin(big_integer_view n, size_t rounds) {
+    thread_local std::mt19937 gen(std::random_device{}());
+
+    big_integer minus_one = big_integer(n) - 1;
+    size_t s = 0;
+    while (((minus_one.view().get_digit(s / CAPACITY) >> (s % CAPACITY)) &
+            1) == 0) {
+        s++;
+    }
+    big_integer d = minus_one >> int(s);
+
+    montgomery m(n);
+    size_t k = m.size();
+    limb_vector buffer(3 * k);
+    uint32_t* base = buffer.data();
+    uint32_t* x = base + k;
+    uint32_t* neg = x + k;
+    m.negate(m.one(), neg);
+    limb_vector random(k);
+    for (size_t round = 0; round < rounds; round++) {
+        if (round == 0) {
+            m.convert(2, base);
+        } else {
+            std::generate(random.begin(), random.end(), std::ref(gen));
+            big_integer a(big_integer_view(random.data(), k, false));
+            m.convert(a % (minus_one - 2) + 2, base);
+        }
+        m.pow(base, d, x);
+        if (std::equal(x, x + k, m.one()) || std::equal(x, x + k, neg)) {
+            continue;
+        }
+        bool witness = true;
+        for (size_t i = 1; i < s && witness; i++) {
+            m.mul(x, x, x);
+            if (std::equal(x, x + k, neg)) {
+                witness = false;
+            } else if (std::equal(x, x + k, m.one())) {
+                break;
+            }
+        }
+        if (witness) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Get>
+std::vector<bool> test_all(size_t count, size_t rounds, Get get) {
+    // vector<bool> packs its elements, so the workers write bytes
+    std::vector<char> prime(count);
+    thread_pool::shared().run(count, [&](size_t i) {
+        prime[i] = is_probable_prime(get(i), rounds);
+    });
+    return std::vector<bool>(prime.begin(), prime.end());
+}
+} // namespace
+
+bool is_probable_prime(big_integer_view n, size_t rounds) {
+    if (n.sign != 0 || n.size == 0) {
+        return false;
+    }
+    bool small = (n.size == 1);
+    if (small && n.digits[0] < 2) {
+        return false;
+    }
+    small_primes const& t = table();
+    size_t begin = 0;
+    for (size_t g = 0; g < t.products.size(); g++) {
+        uint32_t r = rem_limb(n.digits, n.size, t.products[g]);
+        for (size_t i = begin; i < t.ends[g]; i++) {
+            if (r % t.primes[i] == 0) {
+                return small && n.digits[0] == t.primes[i];
+            }
+        }
+        begin = t.ends[g];
+    }
+    if (small && n.digits[0] < SMALL_PRIME_LIMIT * SMALL_PRIME_LIMIT) {
+        return true;
+    }
+    return miller_rabin(n, rounds);
+}
+
+std::vector<bool> is_probable_prime(std::vector<big_integer> const& candidates,
+                                    size_t rounds) {
+    return test_all(candidates.size(), rounds,
+                    [&](size_t i) { return candidates[i].view(); });
+}
+
+std::vector<bool> is_probable_prime(big_integer_array const& candidates,
+                                    size_t rounds) {
+    return test_all(candidates.size(), rounds,
+                    [&](size_t i) { return candidates[i]; });
+}
+
+big_integer next_prime(big_integer_view n, size_t rounds) {
+    if (compare(n, big_integer(2)) < 0) {
+        return 2;
+    }
+    big_integer start = big_integer(n) + 1;
+    if ((start.view().digits[0] & 1) == 0) {
+        start += 1;
+    }
+    // below the limit a candidate may be one of the sieving primes itself
+    while (compare(start, big_integer(SMALL_PRIME_LIMIT)) <= 0) {
+        if (is_probable_prime(start, rounds)) {
+            return start;
+        }
+        start += 2;
+    }
+
+    std::vector<uint32_t> const& primes = table().primes;
+    std::vector<uint32_t> r;
+    residues(start, r);
+    std::vector<bool> composite(SIEVE_WINDOW);
+    while (true) {
+        // candidate j is start + 2 j; primes[0] is 2, which divides none
+        std::fill(composite.begin(), composite.end(), false);
+        for (size_t i = 1; i < primes.size(); i++) {
+            uint32_t p = primes[i];
+            uint32_t j = (p - r[i]) % p * ((p + 1) / 2) % p;
+            for (; j < SIEVE_WINDOW; j += p) {
+                composite[j] = true;
+            }
+        }
+        for (uint32_t j = 0; j < SIEVE_WINDOW; j++) {
+            if (composite[j]) {
+                continue;
+            }
+            big_integer candidate = start + big_integer(2 * j);
+            if (miller_rabin(candidate, rounds)) {
+                return candidate;
+            }
+        }
+        start += big_integer(2 * SIEVE_WINDOW);
+        for (size_t i = 1; i < primes.size(); i++) {
+            r[i] = (r[i] + 2 * SIEVE_WINDOW) % primes[i];
+        }
+    }
+}
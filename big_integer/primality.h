@@ -0,0 +1,27 @@
+#pragma once
+
+#include "big_integer.h"
+#include "big_integer_array.h"
+#include <cstddef>
+#include <vector>
+
+constexpr size_t DEFAULT_PRIME_ROUNDS = 25;
+
+// true when n is prime; a composite n passes with probability below
+// 4^-rounds. Trial division by the primes below 2^12 settles small n and
+// rejects most composites before the Miller-Rabin rounds, which run in
+// Montgomery form modulo n.
+bool is_probable_prime(big_integer_view n,
+                       size_t rounds = DEFAULT_PRIME_ROUNDS);
+
+// result[i] == is_probable_prime(candidates[i], rounds), with the candidates
+// tested concurrently on the shared thread pool
+std::vector<bool> is_probable_prime(std::vector<big_integer> const& candidates,
+                                    size_t rounds = DEFAULT_PRIME_ROUNDS);
+std::vector<bool> is_probable_prime(big_integer_array const& candidates,
+                                    size_t rounds = DEFAULT_PRIME_ROUNDS);
+
+// smallest probable prime greater than n; the candidates are sieved by the
+// small primes a window at a time, so only the survivors are tested
+big_integer next_prime(big_integer_view n,
+                       size_t rounds = DEFAULT_PRIME_ROUNDS);
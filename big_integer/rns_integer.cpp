@@ -0,0 +1,324 @@
+#include "rns_integer.h"
+#include "primality.h"
+#include <stdexcept>
+#include <utility>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr size_t CAPACITY = 32;
+constexpr uint32_t LARGEST_PRIME = (1u << 31) - 1;
+
+// t / 2^32 mod p for t < 2^32 p
+uint32_t redc(uint64_t t, uint32_t p, uint32_t inv) {
+    uint32_t m = static_cast<uint32_t>(t) * inv;
+    uint32_t u = static_cast<uint32_t>((t + uint64_t(m) * p) >> CAPACITY);
+    return u >= p ? u - p : u;
+}
+
+uint32_t pow_mod(uint32_t x, uint32_t e, uint32_t p) {
+    uint64_t res = 1;
+    uint64_t cur = x;
+    for (; e != 0; e >>= 1) {
+        if ((e & 1) != 0) {
+            res = res * cur % p;
+        }
+        cur = cur * cur % p;
+    }
+    return static_cast<uint32_t>(res);
+}
+
+// Lane operations on residues below p < 2^31. A value in [-p, p) is brought
+// into [0, p) by adding p where its sign bit is set.
+struct add_op {
+    uint32_t operator()(uint32_t x, uint32_t y, uint32_t p, uint32_t) const {
+        uint32_t s = x + y;
+        return s >= p ? s - p : s;
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y, __m128i p, __m128i) const {
+        __m128i d = _mm_sub_epi32(_mm_add_epi32(x, y), p);
+        return _mm_add_epi32(d, _mm_and_si128(p, _mm_srai_epi32(d, 31)));
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y, __m256i p, __m256i) const {
+        __m256i d = _mm256_sub_epi32(_mm256_add_epi32(x, y), p);
+        return _mm256_add_epi32(d,
+                                _mm256_and_si256(p, _mm256_srai_epi32(d, 31)));
+    }
+#endif
+};
+
+struct sub_op {
+    uint32_t operator()(uint32_t x, uint32_t y, uint32_t p, uint32_t) const {
+        return x >= y ? x - y : x + (p - y);
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y, __m128i p, __m128i) const {
+        __m128i d = _mm_sub_epi32(x, y);
+        return _mm_add_epi32(d, _mm_and_si128(p, _mm_srai_epi32(d, 31)));
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y, __m256i p, __m256i) const {
+        __m256i d = _mm256_sub_epi32(x, y);
+        return _mm256_add_epi32(d,
+                                _mm256_and_si256(p, _mm256_srai_epi32(d, 31)));
+    }
+#endif
+};
+
+// Montgomery product; the multiplications only see the even 32-bit lanes,
+// so the odd ones are shifted down and their results land in the high
+// halves of the 64-bit sums, where they already belong
+struct mul_op {
+    uint32_t operator()(uint32_t x, uint32_t y, uint32_t p,
+                        uint32_t inv) const {
+        return redc(uint64_t(x) * y, p, inv);
+    }
+#ifdef __SSE2__
+    __m128i operator()(__m128i x, __m128i y, __m128i p, __m128i inv) const {
+        __m128i even = reduce(_mm_mul_epu32(x, y), p, inv);
+        __m128i odd = reduce(_mm_mul_epu32(_mm_srli_epi64(x, 32),
+                                         _mm_srli_epi64(y, 32)),
+                           _mm_srli_epi64(p, 32), _mm_srli_epi64(inv, 32));
+        __m128i u = _mm_or_si128(
+            _mm_srli_epi64(even, 32),
+            _mm_and_si128(odd, _mm_set1_epi64x(int64_t(0xffffffff00000000))));
+        __m128i d = _mm_sub_epi32(u, p);
+        return _mm_add_epi32(d, _mm_and_si128(p, _mm_srai_epi32(d, 31)));
+    }
+
+    // t + (t * inv mod 2^32) p in the 64-bit lanes
+    static __m128i reduce(__m128i t, __m128i p, __m128i inv) {
+        __m128i m = _mm_mul_epu32(t, inv);
+        return _mm_add_epi64(t, _mm_mul_epu32(m, p));
+    }
+#endif
+#ifdef __AVX2__
+    __m256i operator()(__m256i x, __m256i y, __m256i p, __m256i inv) const {
+        __m256i even = reduce(_mm256_mul_epu32(x, y), p, inv);
+        __m256i odd = reduce(_mm256_mul_epu32(_mm256_srli_epi64(x, 32),
+                                            _mm256_srli_epi64(y, 32)),
+                           _mm256_srli_epi64(p, 32),
+                           _mm256_srli_epi64(inv, 32));
+        __m256i u = _mm256_or_si256(
+            _mm256_srli_epi64(even, 32),
+            _mm256_and_si256(odd,
+                             _mm256_set1_epi64x(int64_t(0xffffffff00000000))));
+        __m256i d = _mm256_sub_epi32(u, p);
+        return _mm256_add_epi32(d,
+                                _mm256_and_si256(p, _mm256_srai_epi32(d, 31)));
+    }
+
+    static __m256i reduce(__m256i t, __m256i p, __m256i inv) {
+        __m256i m = _mm256_mul_epu32(t, inv);
+        return _mm256_add_epi64(t, _mm256_mul_epu32(m, p));
+    }
+#endif
+};
+
+// dst[i] = op(dst[i], b[i], p[i], inv[i]) for i < n
+template <typename Op>
+void lanes(uint32_t* dst, uint32_t const* b, uint32_t const* p,
+           uint32_t const* inv, size_t n, Op op) {
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        __m256i q = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(inv + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            op(x, y, q, v));
+    }
+#endif
+#ifdef __SSE2__
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+        __m128i q = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(inv + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), op(x, y, q, v));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = op(dst[i], b[i], p[i], inv[i]);
+    }
+}
+} // namespace
+
+rns_basis::rns_basis(size_t bits) {
+    big_integer bound = big_integer(1) << int(bits + 1);
+    big_integer m = 1;
+    for (uint32_t p = LARGEST_PRIME; m <= bound; p -= 2) {
+        if (is_probable_prime(big_integer(p))) {
+            primes.push_back(p);
+            m *= big_integer(p);
+        }
+    }
+
+    for (uint32_t p : primes) {
+        uint32_t x = p;
+        for (int i = 0; i < 4; i++) {
+            x *= 2 - p * x;
+        }
+        inverses.push_back(0 - x);
+        uint64_t r = (uint64_t(1) << CAPACITY) % p;
+        squares.push_back(static_cast<uint32_t>(r * r % p));
+    }
+    for (size_t i = 0; i < primes.size(); i++) {
+        uint64_t rest = 1;
+        for (size_t j = 0; j < primes.size(); j++) {
+            if (j != i) {
+                rest = rest * primes[j] % primes[i];
+            }
+        }
+        crt.push_back(pow_mod(static_cast<uint32_t>(rest), primes[i] - 2,
+                              primes[i]));
+    }
+
+    tree.emplace_back(primes.begin(), primes.end());
+    while (tree.back().size() > 1) {
+        std::vector<big_integer> const& level = tree.back();
+        std::vector<big_integer> next;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            next.push_back(i + 1 < level.size() ? level[i] * level[i + 1]
+                                                : level[i]);
+        }
+        tree.push_back(std::move(next));
+    }
+}
+
+size_t rns_basis::size() const {
+    return primes.size();
+}
+
+uint32_t rns_basis::prime(size_t i) const {
+    return primes[i];
+}
+
+big_integer const& rns_basis::modulus() const {
+    return tree.back()[0];
+}
+
+rns_integer::rns_integer(std::shared_ptr<rns_basis const> basis)
+    : base(std::move(basis)), residues(base->size()) {}
+
+rns_integer::rns_integer(std::shared_ptr<rns_basis const> basis,
+                         big_integer_view value)
+    : rns_integer(std::move(basis)) {
+    big_integer x(value);
+    bool negative = (x < 0);
+    if (negative) {
+        x = -x;
+    }
+    if (x >= base->modulus()) {
+        x %= base->modulus();
+    }
+    // remainder tree: every node takes the remainder of its parent's
+    std::vector<big_integer> rems{x};
+    for (size_t j = base->tree.size() - 1; j-- > 0;) {
+        std::vector<big_integer> const& level = base->tree[j];
+        std::vector<big_integer> next;
+        for (size_t i = 0; i < level.size(); i++) {
+            big_integer const& parent = rems[i / 2];
+            next.push_back(parent < level[i] ? parent : parent % level[i]);
+        }
+        rems = std::move(next);
+    }
+    for (size_t i = 0; i < residues.size(); i++) {
+        uint32_t p = base->primes[i];
+        uint32_t r = rems[i].view().get_digit(0);
+        if (negative && r != 0) {
+            r = p - r;
+        }
+        uint64_t t = uint64_t(r) * base->squares[i];
+        residues[i] = redc(t, p, base->inverses[i]);
+    }
+}
+
+std::shared_ptr<rns_basis const> const& rns_integer::basis() const {
+    return base;
+}
+
+big_integer rns_integer::value() const {
+    // x = sum(y[i] M / p[i]) mod M with y[i] = r[i] (M / p[i])^-1 mod p[i];
+    // going up the tree a node is sum(y[i] P / p[i]) over its primes, where P
+    // is their product
+    std::vector<big_integer> sums;
+    for (size_t i = 0; i < residues.size(); i++) {
+        uint64_t t = uint64_t(residues[i]) * base->crt[i];
+        sums.emplace_back(redc(t, base->primes[i], base->inverses[i]));
+    }
+    for (size_t j = 0; j + 1 < base->tree.size(); j++) {
+        std::vector<big_integer> const& level = base->tree[j];
+        std::vector<big_integer> next;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            if (i + 1 < level.size()) {
+                next.push_back(sums[i] * level[i + 1] + sums[i + 1] * level[i]);
+            } else {
+                next.push_back(std::move(sums[i]));
+            }
+        }
+        sums = std::move(next);
+    }
+    big_integer const& m = base->modulus();
+    big_integer x = sums[0] % m;
+    if (x + x > m) {
+        x -= m;
+    }
+    return x;
+}
+
+void rns_integer::check(rns_integer const& rhs) const {
+    if (base != rhs.base) {
+        throw std::invalid_argument("rns_integer operands of different bases");
+    }
+}
+
+rns_integer& rns_integer::operator+=(rns_integer const& rhs) {
+    check(rhs);
+    lanes(residues.data(), rhs.residues.data(), base->primes.data(),
+          base->inverses.data(), residues.size(), add_op());
+    return *this;
+}
+
+rns_integer& rns_integer::operator-=(rns_integer const& rhs) {
+    check(rhs);
+    lanes(residues.data(), rhs.residues.data(), base->primes.data(),
+          base->inverses.data(), residues.size(), sub_op());
+    return *this;
+}
+
+rns_integer& rns_integer::operator*=(rns_integer const& rhs) {
+    check(rhs);
+    lanes(residues.data(), rhs.residues.data(), base->primes.data(),
+          base->inverses.data(), residues.size(), mul_op());
+    return *this;
+}
+
+bool operator==(rns_integer const& a, rns_integer const& b) {
+    a.check(b);
+    return a.residues == b.residues;
+}
+
+bool operator!=(rns_integer const& a, rns_integer const& b) {
+    return !(a == b);
+}
+
+rns_integer operator+(rns_integer a, rns_integer const& b) {
+    return a += b;
+}
+
+rns_integer operator-(rns_integer a, rns_integer const& b) {
+    return a -= b;
+}
+
+rns_integer operator*(rns_integer a, rns_integer const& b) {
+    return a *= b;
+}
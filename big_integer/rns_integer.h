@@ -0,0 +1,67 @@
+#pragma once
+
+#include "big_integer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Distinct primes below 2^31 and what converting to and from residues modulo
+// them needs. With M their product, the integers in (-M / 2, M / 2) have
+// distinct residues.
+class rns_basis {
+public:
+    // the fewest primes for which every |x| < 2^bits is representable
+    explicit rns_basis(size_t bits);
+
+    size_t size() const;
+    uint32_t prime(size_t i) const;
+    big_integer const& modulus() const;
+
+private:
+    friend struct rns_integer;
+
+    std::vector<uint32_t> primes;
+    // -1 / p mod 2^32 and 2^64 mod p, for Montgomery products modulo p
+    std::vector<uint32_t> inverses;
+    std::vector<uint32_t> squares;
+    // (M / p)^-1 mod p
+    std::vector<uint32_t> crt;
+    // subproduct tree: tree[0] holds the primes, tree[j + 1][i] is the
+    // product of tree[j][2 i] and tree[j][2 i + 1], and the root is M
+    std::vector<std::vector<big_integer>> tree;
+};
+
+// Integer held as its residues modulo the primes of a basis, each kept in
+// Montgomery form. Sums, differences and products take one independent
+// operation per prime, done several primes at a time with SSE2 or AVX2, and
+// are exact as long as every intermediate value stays representable; only
+// value() pays for the Chinese remainder theorem.
+struct rns_integer {
+    explicit rns_integer(std::shared_ptr<rns_basis const> basis);
+    // value is reduced to the representable range modulo M
+    rns_integer(std::shared_ptr<rns_basis const> basis,
+                big_integer_view value);
+
+    std::shared_ptr<rns_basis const> const& basis() const;
+    big_integer value() const;
+
+    // the operands must share a basis; throw std::invalid_argument otherwise
+    rns_integer& operator+=(rns_integer const& rhs);
+    rns_integer& operator-=(rns_integer const& rhs);
+    rns_integer& operator*=(rns_integer const& rhs);
+
+    friend bool operator==(rns_integer const& a, rns_integer const& b);
+    friend bool operator!=(rns_integer const& a, rns_integer const& b);
+
+private:
+    void check(rns_integer const& rhs) const;
+
+private:
+    std::shared_ptr<rns_basis const> base;
+    std::vector<uint32_t> residues;
+};
+
+rns_integer operator+(rns_integer a, rns_integer const& b);
+rns_integer operator-(rns_integer a, rns_integer const& b);
+rns_integer operator*(rns_integer a, rns_integer const& b);
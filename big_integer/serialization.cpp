@@ -0,0 +1,154 @@
+#include "serialization.h"
+#include <cstring>
+
+namespace {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool LITTLE_ENDIAN_HOST = true;
+#else
+constexpr bool LITTLE_ENDIAN_HOST = false;
+#endif
+
+constexpr size_t MAX_VARINT = 10;
+
+size_t varint_size(uint64_t x) {
+    size_t len = 1;
+    while (x >= 0x80) {
+        x >>= 7;
+        len++;
+    }
+    return len;
+}
+
+size_t header_size(size_t limbs) {
+    size_t len = 1 + varint_size(static_cast<uint64_t>(limbs) << 1);
+    return (len + 3) & ~size_t(3);
+}
+
+uint32_t load_limb(char const* p) {
+    auto const* u = reinterpret_cast<unsigned char const*>(p);
+    return static_cast<uint32_t>(u[0]) | static_cast<uint32_t>(u[1]) << 8 |
+           static_cast<uint32_t>(u[2]) << 16 |
+           static_cast<uint32_t>(u[3]) << 24;
+}
+
+void store_limb(char* p, uint32_t x) {
+    for (size_t i = 0; i < 4; i++) {
+        p[i] = static_cast<char>(x >> (8 * i));
+    }
+}
+
+struct header {
+    char const* limbs;
+    size_t size;
+    uint32_t sign;
+};
+
+// parses everything up to the limbs and checks that they fit in the buffer
+// and are normalized
+std::errc read_header(char const* first, char const* last, header& h) {
+    if (first == last || static_cast<uint8_t>(*first) != SERIAL_VERSION) {
+        return std::errc::invalid_argument;
+    }
+    char const* p = first + 1;
+    uint64_t x = 0;
+    for (size_t shift = 0;; shift += 7) {
+        if (p == last || shift == 7 * MAX_VARINT) {
+            return std::errc::invalid_argument;
+        }
+        uint64_t byte = static_cast<uint8_t>(*p++);
+        if (shift == 63 && byte > 1) {
+            return std::errc::invalid_argument;
+        }
+        x |= (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            break;
+        }
+    }
+    while ((p - first) % 4 != 0) {
+        if (p == last || *p != 0) {
+            return std::errc::invalid_argument;
+        }
+        p++;
+    }
+    uint64_t size = x >> 1;
+    if (size > static_cast<uint64_t>(last - p) / 4) {
+        return std::errc::invalid_argument;
+    }
+    h.limbs = p;
+    h.size = size;
+    h.sign = (x & 1) != 0 ? UINT32_MAX : 0;
+    // the top limb of a normalized value differs from the sign
+    if (size != 0 && load_limb(p + 4 * (size - 1)) == h.sign) {
+        return std::errc::invalid_argument;
+    }
+    return std::errc();
+}
+
+} // namespace
+
+size_t serialized_size(big_integer_view value) {
+    return header_size(value.size) + 4 * value.size;
+}
+
+std::to_chars_result serialize(char* first, char* last,
+                               big_integer_view value) {
+    size_t len = serialized_size(value);
+    if (static_cast<size_t>(last - first) < len) {
+        return {last, std::errc::value_too_large};
+    }
+    char* p = first;
+    *p++ = static_cast<char>(SERIAL_VERSION);
+    uint64_t x = static_cast<uint64_t>(value.size) << 1 | (value.sign & 1);
+    while (x >= 0x80) {
+        *p++ = static_cast<char>(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = static_cast<char>(x);
+    while ((p - first) % 4 != 0) {
+        *p++ = 0;
+    }
+    if (LITTLE_ENDIAN_HOST && value.size != 0) {
+        std::memcpy(p, value.digits, 4 * value.size);
+    } else {
+        for (size_t i = 0; i < value.size; i++) {
+            store_limb(p + 4 * i, value.digits[i]);
+        }
+    }
+    return {first + len, std::errc()};
+}
+
+std::from_chars_result deserialize(char const* first, char const* last,
+                                   big_integer& value) {
+    header h;
+    std::errc ec = read_header(first, last, h);
+    if (ec != std::errc()) {
+        return {first, ec};
+    }
+    value.number.resize(h.size);
+    if (LITTLE_ENDIAN_HOST && h.size != 0) {
+        std::memcpy(value.number.data(), h.limbs, 4 * h.size);
+    } else {
+        for (size_t i = 0; i < h.size; i++) {
+            value.number[i] = load_limb(h.limbs + 4 * i);
+        }
+    }
+    value.sign = h.sign;
+    return {h.limbs + 4 * h.size, std::errc()};
+}
+
+std::from_chars_result deserialize(char const* first, char const* last,
+                                   big_integer_view& value) {
+    header h;
+    std::errc ec = read_header(first, last, h);
+    if (ec == std::errc() &&
+        (!LITTLE_ENDIAN_HOST ||
+         reinterpret_cast<uintptr_t>(h.limbs) % alignof(uint32_t) != 0)) {
+        ec = std::errc::not_supported;
+    }
+    if (ec != std::errc()) {
+        return {first, ec};
+    }
+    value = big_integer_view(reinterpret_cast<uint32_t const*>(h.limbs),
+                             h.size, h.sign != 0);
+    return {h.limbs + 4 * h.size, std::errc()};
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "big_integer.h"
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+
+// Binary format of a single value, version 1:
+//   version  one byte, SERIAL_VERSION
+//   header   varint (7 bits per byte, low bits first) of size << 1 | negative
+//   padding  zero bytes up to a multiple of 4 from the start of the record
+//   limbs    size little-endian 32-bit two's complement limbs, least
+//            significant first, without redundant sign limbs
+// Records written at 4-byte aligned addresses can be read back in place.
+constexpr uint8_t SERIAL_VERSION = 1;
+
+size_t serialized_size(big_integer_view value);
+
+// fails with errc::value_too_large when [first, last) is shorter than
+// serialized_size(value)
+std::to_chars_result serialize(char* first, char* last,
+                               big_integer_view value);
+
+// both report the end of the record and fail with errc::invalid_argument on a
+// truncated or malformed record or an unknown version; the view points into
+// [first, last) and also fails, with errc::not_supported, when the limbs are
+// not 4-byte aligned or the host is not little-endian
+std::from_chars_result deserialize(char const* first, char const* last,
+                                   big_integer& value);
+std::from_chars_result deserialize(char const* first, char const* last,
+                                   big_integer_view& value);
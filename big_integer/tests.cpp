@@ -3,9 +3,26 @@
 #include <cstdlib>
 #include <string>
 #include <limits>
+#include <random>
+#include <iomanip>
+#include <sstream>
+#include <memory_resource>
+#include <thread>
 #include <gtest/gtest.h>
 
+#include "big_accumulator.h"
+#include "big_integer_array.h"
 #include "big_integer.h"
+#include "big_integer_expr.h"
+#include "big_integer_literals.h"
+#include "big_rational.h"
+#include "decimal_integer.h"
+#include "fixed_integer.h"
+#include "mapped_integer.h"
+#include "parallel.h"
+#include "primality.h"
+#include "rns_integer.h"
+#include "serialization.h"
 
 TEST(correctness, two_plus_two)
 {
@@ -750,3 +767,1092 @@ TEST(correctness, converting_ctor4)
     EXPECT_EQ(to_string(bignum), std::to_string(num));
 }
 
+
+TEST(correctness, factorial)
+{
+    big_integer expected = 1;
+    for (uint32_t n = 0; n <= 300; n++) {
+        if (n != 0) {
+            expected *= n;
+        }
+        EXPECT_EQ(expected, factorial(n));
+    }
+    EXPECT_EQ(to_string(factorial(25)), "15511210043330985984000000");
+}
+
+TEST(correctness, binomial)
+{
+    std::vector<big_integer> row = {1};
+    for (uint32_t n = 1; n <= 120; n++) {
+        std::vector<big_integer> next(n + 1, 1);
+        for (uint32_t k = 1; k < n; k++) {
+            next[k] = row[k - 1] + row[k];
+        }
+        row.swap(next);
+        for (uint32_t k = 0; k <= n; k++) {
+            EXPECT_EQ(row[k], binomial(n, k));
+        }
+    }
+    EXPECT_EQ(0, binomial(5, 6));
+}
+
+TEST(correctness, product)
+{
+    std::vector<big_integer> values;
+    big_integer expected = 1;
+    for (int i = 1; i <= 50; i++) {
+        values.push_back(big_integer(i) * (i % 3 == 0 ? -i : i));
+        expected *= values.back();
+    }
+    EXPECT_EQ(expected, product(values.begin(), values.end()));
+    EXPECT_EQ(1, product(values.begin(), values.begin()));
+}
+
+namespace
+{
+    big_integer random_big_integer(std::mt19937& gen, size_t limbs)
+    {
+        big_integer res = 0;
+        for (size_t i = 0; i < limbs; i++) {
+            res <<= 32;
+            res += static_cast<uint32_t>(gen());
+        }
+        return gen() % 2 ? -res : res;
+    }
+}
+
+TEST(correctness, mul_limb_sizes)
+{
+    big_integer a(static_cast<int64_t>(-4294967296));
+    EXPECT_EQ(a + a + a, a * 3);
+    EXPECT_EQ(a + a + a, 3 * a);
+}
+
+TEST(correctness, parallel_mul)
+{
+    std::mt19937 gen(42);
+    std::vector<std::pair<big_integer, big_integer>> cases;
+    std::vector<big_integer> serial;
+    for (size_t n : {1, 5, 40, 130}) {
+        for (size_t m : {1, 7, 64, 200}) {
+            cases.emplace_back(random_big_integer(gen, n),
+                               random_big_integer(gen, m));
+            serial.push_back(cases.back().first * cases.back().second);
+        }
+    }
+    set_parallel_mul(4, 1);
+    for (size_t i = 0; i < cases.size(); i++) {
+        EXPECT_EQ(serial[i], cases[i].first * cases[i].second);
+    }
+    set_parallel_mul(1);
+}
+
+TEST(correctness, parallel_sum_product)
+{
+    std::mt19937 gen(7);
+    std::vector<big_integer> values;
+    big_integer sum = 0;
+    big_integer prod = 1;
+    for (size_t i = 0; i < 1000; i++) {
+        values.push_back(random_big_integer(gen, 1 + i % 5));
+        sum += values.back();
+        if (i < 300) {
+            prod *= values.back();
+        }
+    }
+    EXPECT_EQ(sum, parallel_sum(values.begin(), values.end()));
+    EXPECT_EQ(prod, parallel_product(values.begin(), values.begin() + 300));
+    EXPECT_EQ(0, parallel_sum(values.begin(), values.begin()));
+    EXPECT_EQ(1, parallel_product(values.begin(), values.begin()));
+}
+
+TEST(correctness, big_accumulator)
+{
+    std::mt19937 gen(11);
+    big_integer expected = 0;
+    big_accumulator acc;
+    for (size_t i = 0; i < 2000; i++) {
+        big_integer x = random_big_integer(gen, gen() % 4 == 0 ? 6 : 1);
+        if (i % 3 == 0) {
+            expected -= x;
+            acc -= x;
+        } else {
+            expected += x;
+            acc += x;
+        }
+        if (i % 250 == 0) {
+            EXPECT_EQ(expected, acc.value());
+        }
+    }
+    EXPECT_EQ(expected, acc.value());
+
+    big_accumulator other(expected);
+    other += acc;
+    other -= -1;
+    EXPECT_EQ(expected * 2 + 1, other.value());
+    EXPECT_EQ(0, big_accumulator().value());
+}
+
+TEST(correctness, big_accumulator_merge_negative)
+{
+    big_accumulator a(big_integer(-1));
+    big_accumulator b(big_integer(-1));
+    a += b;
+    a += big_integer("18446744073709551616");
+    EXPECT_EQ(big_integer("18446744073709551614"), a.value());
+
+    big_integer wide = -(big_integer(1) << 200);
+    big_accumulator c(wide);
+    c += big_accumulator(wide);
+    c += big_accumulator(big_integer(-3));
+    c += big_integer(1) << 300;
+    c -= big_integer(1) << 400;
+    EXPECT_EQ(wide * 2 - 3 + (big_integer(1) << 300) -
+                  (big_integer(1) << 400),
+              c.value());
+}
+
+TEST(correctness, add_mul)
+{
+    std::mt19937 gen(5);
+    for (size_t i = 0; i < 50; i++) {
+        big_integer a = random_big_integer(gen, 1 + i % 7);
+        big_integer b = random_big_integer(gen, 1 + i % 3);
+        big_integer c = random_big_integer(gen, 1 + i % 11);
+        big_integer expected = c + a * b;
+        EXPECT_EQ(expected, big_integer(c).add_mul(a, b));
+        EXPECT_EQ(c - a * b, big_integer(c).sub_mul(a, b));
+        EXPECT_EQ(a + a * a, big_integer(a).add_mul(a, a));
+    }
+}
+
+TEST(correctness, lazy_expressions)
+{
+    std::mt19937 gen(9);
+    big_integer a = random_big_integer(gen, 4);
+    big_integer b = random_big_integer(gen, 3);
+    big_integer c = random_big_integer(gen, 5);
+    big_integer d = random_big_integer(gen, 2);
+    big_integer e = random_big_integer(gen, 6);
+
+    big_integer r = lazy(a) * b + lazy(c) * d - e;
+    EXPECT_EQ(a * b + c * d - e, r);
+
+    r = e - lazy(a) * b * c + d * lazy(3);
+    EXPECT_EQ(e - a * b * c + d * 3, r);
+
+    r = lazy(r) * a + r;
+    EXPECT_EQ((e - a * b * c + d * 3) * (a + 1), r);
+
+    big_integer acc = c;
+    acc += lazy(a) * b;
+    acc -= lazy(d) * e - a;
+    EXPECT_EQ(c + a * b - d * e + a, acc);
+
+    acc -= lazy(acc) * 2;
+    EXPECT_EQ(-(c + a * b - d * e + a), acc);
+}
+
+TEST(correctness, bitwise_long)
+{
+    std::mt19937 gen(3);
+    for (size_t i = 0; i < 200; i++) {
+        big_integer a = random_big_integer(gen, 1 + gen() % 40);
+        big_integer b = random_big_integer(gen, 1 + gen() % 40);
+        EXPECT_EQ(a + b, (a & b) + (a | b));
+        EXPECT_EQ(a ^ b, (a | b) - (a & b));
+        EXPECT_EQ(-a - 1, ~a);
+        EXPECT_EQ(a, ~~a);
+        EXPECT_EQ(0, a ^ a);
+        EXPECT_EQ(a, a & a);
+    }
+}
+
+TEST(correctness, shifts_long)
+{
+    std::mt19937 gen(13);
+    for (size_t i = 0; i < 200; i++) {
+        big_integer a = random_big_integer(gen, 1 + gen() % 30);
+        int k = gen() % 700;
+        big_integer pow2 = big_integer(1) << k;
+        EXPECT_EQ(a * pow2, a << k);
+        EXPECT_EQ(a, (a << k) >> k);
+        EXPECT_EQ(a - (a & (pow2 - 1)), (a >> k) << k);
+        EXPECT_EQ(a >> k, a << -k);
+    }
+    EXPECT_EQ(-1, big_integer(-5) >> 1000);
+    EXPECT_EQ(0, big_integer(5) >> 1000);
+
+    int min = std::numeric_limits<int>::min();
+    EXPECT_EQ(0, big_integer(5) << min);
+    EXPECT_EQ(-1, big_integer(-5) << min);
+    EXPECT_EQ(0, big_integer(0) >> min);
+}
+
+TEST(correctness, bit_queries)
+{
+    big_integer a("340282366920938463463374607431768211456"); // 2^128
+    EXPECT_EQ(129u, a.bit_length());
+    EXPECT_EQ(1u, a.popcount());
+    EXPECT_EQ(128u, a.count_trailing_zeros());
+    EXPECT_TRUE(a.test_bit(128));
+    EXPECT_FALSE(a.test_bit(127));
+
+    big_integer b = -a;
+    EXPECT_EQ(128u, b.bit_length());
+    EXPECT_EQ(128u, b.popcount());
+    EXPECT_EQ(128u, b.count_trailing_zeros());
+    EXPECT_TRUE(b.test_bit(1000));
+
+    EXPECT_EQ(0u, big_integer(0).bit_length());
+    EXPECT_EQ(0u, big_integer(-1).bit_length());
+    EXPECT_EQ(0u, big_integer(0).count_trailing_zeros());
+    EXPECT_EQ(3u, big_integer(-8).count_trailing_zeros());
+
+    big_integer c = 0;
+    c.set_bit(100).set_bit(3);
+    EXPECT_EQ((big_integer(1) << 100) + 8, c);
+    c.clear_bit(100).clear_bit(200);
+    EXPECT_EQ(8, c);
+
+    big_integer d = -1;
+    d.clear_bit(64);
+    EXPECT_EQ(-1 - (big_integer(1) << 64), d);
+    d.set_bit(64);
+    EXPECT_EQ(-1, d);
+}
+
+namespace
+{
+    big_integer wrap(big_integer const& a, int bits, bool is_signed)
+    {
+        big_integer mod = big_integer(1) << bits;
+        big_integer res = a & (mod - 1);
+        if (is_signed && res.test_bit(bits - 1)) {
+            res -= mod;
+        }
+        return res;
+    }
+
+    template <size_t Bits, bool Signed>
+    void test_fixed_integer(std::mt19937& gen)
+    {
+        using fixed = fixed_integer<Bits, Signed>;
+        int bits = static_cast<int>(Bits);
+        for (size_t i = 0; i < 100; i++) {
+            big_integer a = wrap(random_big_integer(gen, 1 + gen() % (Bits / 32)), bits, Signed);
+            big_integer b = wrap(random_big_integer(gen, 1 + gen() % (Bits / 32)), bits, Signed);
+            fixed fa(a);
+            fixed fb(b);
+            int k = gen() % (bits + 10);
+            EXPECT_EQ(a, big_integer(fa));
+            EXPECT_EQ(wrap(a + b, bits, Signed), big_integer(fa + fb));
+            EXPECT_EQ(wrap(a - b, bits, Signed), big_integer(fa - fb));
+            EXPECT_EQ(wrap(a * b, bits, Signed), big_integer(fa * fb));
+            EXPECT_EQ(wrap(a & b, bits, Signed), big_integer(fa & fb));
+            EXPECT_EQ(wrap(a | b, bits, Signed), big_integer(fa | fb));
+            EXPECT_EQ(wrap(a ^ b, bits, Signed), big_integer(fa ^ fb));
+            EXPECT_EQ(wrap(~a, bits, Signed), big_integer(~fa));
+            EXPECT_EQ(wrap(a << k, bits, Signed), big_integer(fa << k));
+            EXPECT_EQ(wrap(a >> k, bits, Signed), big_integer(fa >> k));
+            EXPECT_EQ(a < b, fa < fb);
+            EXPECT_EQ(a == b, fa == fb);
+            if (b != 0) {
+                EXPECT_EQ(a / b, big_integer(fa / fb));
+                EXPECT_EQ(a % b, big_integer(fa % fb));
+                big_integer c = static_cast<uint32_t>(gen()) | 1;
+                EXPECT_EQ(a / c, big_integer(fa / fixed(c)));
+            }
+        }
+    }
+}
+
+TEST(correctness, fixed_integer)
+{
+    std::mt19937 gen(17);
+    test_fixed_integer<64, true>(gen);
+    test_fixed_integer<128, true>(gen);
+    test_fixed_integer<128, false>(gen);
+    test_fixed_integer<256, true>(gen);
+    test_fixed_integer<512, false>(gen);
+
+    constexpr int256_fixed a = int256_fixed(1) << 200;
+    constexpr int256_fixed b = a * 3 / 7 - 1;
+    static_assert(b < a, "constexpr arithmetic");
+    EXPECT_EQ((big_integer(1) << 200) * 3 / 7 - 1, big_integer(b));
+    EXPECT_EQ("-1", to_string(int128_fixed(-1)));
+    EXPECT_EQ("340282366920938463463374607431768211455", to_string(uint128_fixed(-1)));
+
+    int128_fixed x(12345);
+    EXPECT_THROW(x / int128_fixed(0), std::domain_error);
+    EXPECT_THROW(x % int128_fixed(0), std::domain_error);
+    EXPECT_THROW(uint256_fixed(7) /= uint256_fixed(0), std::domain_error);
+
+    constexpr int min = std::numeric_limits<int>::min();
+    static_assert((int128_fixed(5) << min) == 0, "constexpr shift by INT_MIN");
+    EXPECT_EQ(-1, big_integer(int128_fixed(-5) << min));
+    EXPECT_EQ(0, big_integer(int128_fixed(-5) >> min));
+    EXPECT_EQ(big_integer(int256_fixed(-40) >> 3), big_integer(int256_fixed(-40) << -3));
+}
+
+TEST(correctness, mod_short)
+{
+    big_integer a("123456789012345678901");
+    EXPECT_EQ(big_integer(296298508), a % big_integer(4000000007u));
+    EXPECT_EQ(big_integer(-296298508), -a % big_integer(4000000007u));
+}
+
+TEST(correctness, literals)
+{
+    EXPECT_EQ(big_integer("123456789012345678901234567890"), 123456789012345678901234567890_bi);
+    EXPECT_EQ(big_integer("-123456789012345678901234567890"), -123456789012345678901234567890_bi);
+    EXPECT_EQ(0, 0_bi);
+    EXPECT_EQ(4294967295u, 4294967295_bi);
+    EXPECT_EQ(big_integer(1) << 100, 0x10000000000000000000000000_bi);
+    EXPECT_EQ(big_integer(1) << 96, 0X1'0000'0000'0000'0000'0000'0000_bi);
+    EXPECT_EQ(255, 0xfF_bi);
+    EXPECT_EQ(10, 0b1010_bi);
+    EXPECT_EQ(83, 0123_bi);
+    EXPECT_EQ(1000000, 1'000'000_bi);
+
+    // 1.5_bi, 1e5_bi and 0x1p3_bi fail the static_assert in operator""_bi;
+    // the compiler itself already rejects 0b12_bi and 09_bi
+    using literal_detail::valid;
+    static_assert(valid<'0'>() && valid<'0', 'x', 'f', '\'', 'F'>(), "");
+    static_assert(!valid<'1', '.', '5'>() && !valid<'1', 'e', '5'>(), "");
+    static_assert(!valid<'0', 'x', '1', 'p', '3'>(), "");
+    static_assert(!valid<'0', 'b', '1', '2'>() && !valid<'0', '9'>(), "");
+}
+
+TEST(correctness, from_chars)
+{
+    std::string str = "-123456789012345678901234567890xyz";
+    big_integer a = 7;
+    auto res = from_chars(str.data(), str.data() + str.size(), a);
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ(str.data() + 31, res.ptr);
+    EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+
+    str = "+5";
+    res = from_chars(str.data(), str.data() + str.size(), a);
+    EXPECT_EQ(std::errc::invalid_argument, res.ec);
+    EXPECT_EQ(str.data(), res.ptr);
+    EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+
+    str = "ffffffffffffffffffffffffffffffff";
+    from_chars(str.data(), str.data() + str.size(), a, 16);
+    EXPECT_EQ((big_integer(1) << 128) - 1, a);
+
+    str = "-zz";
+    from_chars(str.data(), str.data() + str.size(), a, 36);
+    EXPECT_EQ(-1295, a);
+
+    EXPECT_EQ(big_integer(42), big_integer(std::string_view("42 and more").substr(0, 2)));
+    EXPECT_EQ(big_integer(42), big_integer("+42"));
+    EXPECT_EQ(big_integer(0), big_integer("-0"));
+}
+
+TEST(correctness, to_chars)
+{
+    big_integer a("-123456789012345678901234567890");
+    char buf[64];
+    auto res = to_chars(buf, buf + sizeof(buf), a);
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ("-123456789012345678901234567890", std::string(buf, res.ptr));
+    EXPECT_LE(size_t(res.ptr - buf), to_chars_size(a));
+
+    res = to_chars(buf, buf + 10, a);
+    EXPECT_EQ(std::errc::value_too_large, res.ec);
+
+    res = to_chars(buf, buf + sizeof(buf), big_integer(-1295), 36);
+    EXPECT_EQ("-zz", std::string(buf, res.ptr));
+    res = to_chars(buf, buf + sizeof(buf), big_integer(0), 2);
+    EXPECT_EQ("0", std::string(buf, res.ptr));
+
+    std::mt19937 gen(19);
+    for (size_t i = 0; i < 100; i++) {
+        big_integer x = random_big_integer(gen, 1 + gen() % 20);
+        int base = 2 + gen() % 35;
+        std::string out(to_chars_size(x, base), '?');
+        auto end = to_chars(out.data(), out.data() + out.size(), x, base).ptr;
+        big_integer y;
+        auto back = from_chars(out.data(), end, y, base);
+        EXPECT_EQ(end, back.ptr);
+        EXPECT_EQ(x, y);
+    }
+}
+
+TEST(correctness, pow2_radix)
+{
+    big_integer a("-340282366920938463463374607431768211456"); // -2^128
+    EXPECT_EQ("-100000000000000000000000000000000", to_string(a, 16));
+    EXPECT_EQ("-ffffffffffffffffffffffffffffffff", to_string(a + 1, 16));
+    EXPECT_EQ("0", to_string(big_integer(0), 2));
+    EXPECT_EQ("-1", to_string(big_integer(-1), 8));
+    EXPECT_EQ("101", to_string(big_integer(5), 2));
+    EXPECT_EQ("deadbeef0123456789abcdef", to_string(0xdeadbeef0123456789abcdef_bi, 16));
+
+    std::mt19937 gen(23);
+    for (size_t i = 0; i < 200; i++) {
+        big_integer x = random_big_integer(gen, 1 + gen() % 20) >> (gen() % 32);
+        for (int base : {2, 4, 8, 16, 32}) {
+            std::string str = to_string(x, base);
+            big_integer y;
+            auto res = from_chars(str.data(), str.data() + str.size(), y, base);
+            EXPECT_EQ(str.data() + str.size(), res.ptr);
+            EXPECT_EQ(x, y);
+            big_integer z = 0;
+            for (char c : str) {
+                if (c != '-') {
+                    z = z * base + (c <= '9' ? c - '0' : c - 'a' + 10);
+                }
+            }
+            EXPECT_EQ(x < 0 ? -x : x, z);
+        }
+    }
+}
+
+TEST(correctness, decimal_io_long)
+{
+    std::mt19937 gen(29);
+    for (size_t len : {1, 9, 15, 16, 17, 18, 19, 20, 37, 38, 100, 333}) {
+        std::string str(len, '0');
+        str[0] = '1' + gen() % 9;
+        for (size_t i = 1; i < len; i++) {
+            str[i] = '0' + gen() % 10;
+        }
+        big_integer a(str);
+        EXPECT_EQ(str, to_string(a));
+        EXPECT_EQ("-" + str, to_string(-a));
+
+        big_integer b = 0;
+        for (char c : str) {
+            b = b * 10 + (c - '0');
+        }
+        EXPECT_EQ(b, a);
+    }
+    EXPECT_EQ("1000000000000000000", to_string(big_integer("1000000000000000000")));
+    EXPECT_THROW(big_integer("12345678901234567890123x5"), std::invalid_argument);
+    EXPECT_THROW(big_integer("1234567890123456:7890123"), std::invalid_argument);
+}
+
+TEST(correctness, stream_output)
+{
+    big_integer a("-123456789012345678901234567890");
+    std::ostringstream out;
+    out << a << ' ' << std::showpos << -a << std::noshowpos << ' ' << big_integer(0);
+    EXPECT_EQ("-123456789012345678901234567890 +123456789012345678901234567890 0", out.str());
+
+    out.str("");
+    out << std::hex << (big_integer(255) << 64) << ' ' << std::showbase << std::uppercase
+        << big_integer(-255) << std::noshowbase << std::nouppercase << ' ' << std::oct << big_integer(-8);
+    EXPECT_EQ("ff0000000000000000 -0XFF -10", out.str());
+
+    out.str("");
+    out << std::dec << std::setw(8) << big_integer(-42) << '|' << std::left << std::setw(6) << std::setfill('*')
+        << big_integer(42) << '|' << std::internal << std::setw(6) << big_integer(-42);
+    EXPECT_EQ("     -42|42****|-***42", out.str());
+
+    out.str("");
+    out << std::hex << std::uppercase << std::showbase << std::right << std::setfill('x') << std::setw(10)
+        << big_integer(0xabc) << '|' << std::internal << std::setw(10) << big_integer(-0xabc)
+        << std::nouppercase << std::noshowbase << std::setfill(' ');
+    EXPECT_EQ("xxxxx0XABC|-0XxxxxABC", out.str());
+
+    std::mt19937 gen(31);
+    big_integer b = random_big_integer(gen, 3000);
+    out.str("");
+    out << std::dec << b;
+    EXPECT_EQ(to_string(b), out.str());
+}
+
+TEST(correctness, stream_input)
+{
+    std::istringstream in("  -123456789012345678901234567890 +42 ff0000000000000000 0x1F 777 abc");
+    big_integer a, b, c, d, e;
+    in >> a >> b >> std::hex >> c >> d >> std::oct >> e;
+    EXPECT_EQ(big_integer("-123456789012345678901234567890"), a);
+    EXPECT_EQ(42, b);
+    EXPECT_EQ(big_integer(255) << 64, c);
+    EXPECT_EQ(31, d);
+    EXPECT_EQ(511, e);
+    EXPECT_TRUE(in.good());
+    in >> std::dec >> a;
+    EXPECT_TRUE(in.fail());
+
+    std::mt19937 gen(37);
+    big_integer x = random_big_integer(gen, 500);
+    std::stringstream io;
+    io << x << ' ' << std::hex << x << ' ' << std::oct << x;
+    big_integer y, z, w;
+    io >> std::dec >> y >> std::hex >> z >> std::oct >> w;
+    EXPECT_EQ(x, y);
+    EXPECT_EQ(x, z);
+    EXPECT_EQ(x, w);
+    EXPECT_TRUE(io.eof());
+}
+
+TEST(correctness, views)
+{
+    std::mt19937 gen(41);
+    big_integer a = random_big_integer(gen, 40).abs();
+    big_integer b = -random_big_integer(gen, 25).abs();
+    big_integer_view v = b.view();
+
+    EXPECT_EQ(a + b, a + v);
+    EXPECT_EQ(a - b, a - v);
+    EXPECT_EQ(a * b, a * v);
+    EXPECT_EQ(a / b, a / v);
+    EXPECT_EQ(a % b, a % v);
+    EXPECT_EQ(a & b, a & v);
+    EXPECT_EQ(a | b, a | v);
+    EXPECT_EQ(a ^ b, a ^ v);
+    EXPECT_TRUE(v < a.view());
+    EXPECT_TRUE(b == v);
+    EXPECT_EQ(b, big_integer(v));
+
+    big_integer c = a;
+    c -= c.view();
+    EXPECT_EQ(0, c);
+    c = b;
+    c *= c.view();
+    EXPECT_EQ(b * b, c);
+
+    uint32_t limbs[] = {0, 0x80000000u};
+    EXPECT_EQ(big_integer(1) << 63, big_integer(big_integer_view(limbs, 2, false)));
+    EXPECT_EQ(-(big_integer(1) << 63), big_integer(big_integer_view(limbs + 1, 1, true)) << 32);
+}
+
+TEST(correctness, serialization)
+{
+    std::mt19937 gen(43);
+    std::vector<big_integer> values = {0, -1, 1, big_integer(1) << 31, -(big_integer(1) << 32),
+                                       random_big_integer(gen, 100), -random_big_integer(gen, 3000)};
+    for (big_integer const& x : values) {
+        std::vector<uint32_t> storage(serialized_size(x) / 4 + 1);
+        char* buf = reinterpret_cast<char*>(storage.data());
+        char* end = buf + serialized_size(x);
+        EXPECT_EQ(0u, serialized_size(x) % 4);
+        EXPECT_EQ(std::errc::value_too_large, serialize(buf, end - 1, x).ec);
+        std::to_chars_result w = serialize(buf, end + 4, x);
+        ASSERT_EQ(std::errc(), w.ec);
+        EXPECT_EQ(end, w.ptr);
+
+        big_integer y = 12345;
+        std::from_chars_result r = deserialize(buf, end + 4, y);
+        EXPECT_EQ(std::errc(), r.ec);
+        EXPECT_EQ(end, r.ptr);
+        EXPECT_EQ(x, y);
+
+        big_integer_view v;
+        r = deserialize(buf, end, v);
+        EXPECT_EQ(std::errc(), r.ec);
+        EXPECT_EQ(end, r.ptr);
+        EXPECT_EQ(x, big_integer(v));
+        if (v.size != 0) {
+            EXPECT_EQ(reinterpret_cast<uint32_t const*>(end) - v.size, v.digits);
+        }
+        EXPECT_EQ(std::errc::invalid_argument, deserialize(buf, end - 1, y).ec);
+    }
+
+    // version, then 2 limbs with the sign bit set, padding, limbs
+    char const record[] = {1, 5, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0};
+    big_integer y;
+    EXPECT_EQ(std::errc(), deserialize(record, record + 12, y).ec);
+    EXPECT_EQ(-(big_integer(0xffffffffu) << 32), y);
+
+    char bad_version[] = {2, 0, 0, 0};
+    char not_normalized[] = {1, 2, 0, 0, 0, 0, 0, 0};
+    char bad_padding[] = {1, 0, 1, 0};
+    EXPECT_EQ(std::errc::invalid_argument, deserialize(bad_version, bad_version + 4, y).ec);
+    EXPECT_EQ(std::errc::invalid_argument, deserialize(not_normalized, not_normalized + 8, y).ec);
+    EXPECT_EQ(std::errc::invalid_argument, deserialize(bad_padding, bad_padding + 4, y).ec);
+
+    uint32_t storage[4] = {};
+    char* buf = reinterpret_cast<char*>(storage) + 1;
+    ASSERT_EQ(std::errc(), serialize(buf, buf + 8, big_integer(7)).ec);
+    big_integer_view v;
+    EXPECT_EQ(std::errc::not_supported, deserialize(buf, buf + 8, v).ec);
+    EXPECT_EQ(std::errc(), deserialize(buf, buf + 8, y).ec);
+    EXPECT_EQ(7, y);
+}
+
+TEST(correctness, mapped_integer)
+{
+    std::string path = testing::TempDir() + "mapped_integer_test";
+    std::mt19937 gen(47);
+    big_integer a = random_big_integer(gen, 60);
+    big_integer b = random_big_integer(gen, 80);
+    {
+        mapped_integer m = mapped_integer::create(path, a);
+        EXPECT_EQ(a, big_integer(m.view()));
+        m += b;
+        EXPECT_EQ(a + b, big_integer(m.view()));
+        m -= a;
+        m -= a;
+        EXPECT_EQ(b - a, big_integer(m.view()));
+        m *= 1000000007u;
+        EXPECT_EQ((b - a) * 1000000007, big_integer(m.view()));
+        EXPECT_EQ(compare(m.view(), b), compare((b - a) * 1000000007, b));
+        m += m.view();
+        EXPECT_EQ((b - a) * 2000000014, big_integer(m.view()));
+        m -= m.view();
+        EXPECT_EQ(0, big_integer(m.view()));
+        m -= big_integer(1) << 64;
+        EXPECT_TRUE(m.is_negative());
+        EXPECT_EQ(2u, m.size());
+    }
+    {
+        mapped_integer m = mapped_integer::open(path, true);
+        EXPECT_EQ(-(big_integer(1) << 64), big_integer(m.view()));
+        std::ostringstream out;
+        m.write_decimal(out);
+        EXPECT_EQ("-18446744073709551616", out.str());
+        EXPECT_THROW(m *= 2u, std::logic_error);
+    }
+    for (big_integer const& x : {big_integer(0), big_integer(-1), a, b, a * b * b, -(big_integer(1) << 96)}) {
+        std::ostringstream out;
+        mapped_integer::create(path, x).write_decimal(out);
+        EXPECT_EQ(to_string(x), out.str());
+    }
+
+    // a record from serialize() gets the fixed-width header when opened for writing
+    std::vector<char> record(serialized_size(a));
+    serialize(record.data(), record.data() + record.size(), a);
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    std::fwrite(record.data(), 1, record.size(), f);
+    std::fclose(f);
+    {
+        mapped_integer m = mapped_integer::open(path);
+        m += 1;
+        EXPECT_EQ(a + 1, big_integer(m.view()));
+    }
+
+    // values spanning several windows
+    big_integer c = (big_integer(1) << (32 * (mapped_integer::WINDOW_LIMBS + 5))) - 1;
+    {
+        mapped_integer m = mapped_integer::create(path, c);
+        m *= 3u;
+        m += c;
+        m -= 1;
+        EXPECT_EQ(c * 4 - 1, big_integer(m.view()));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(correctness, mapped_integer_decimal)
+{
+    std::string path = testing::TempDir() + "mapped_integer_decimal_test";
+    std::mt19937 gen(59);
+    // small windows put the powers and the parts in flight in scratch files
+    mapped_integer::set_window_limbs(256);
+    auto power_of_ten = [](size_t n) { return big_integer("1" + std::string(n, '0')); };
+    std::vector<big_integer> values = {
+        random_big_integer(gen, 3000),
+        -random_big_integer(gen, 1500) * random_big_integer(gen, 1500),
+        big_integer(7) + power_of_ten(9 * 300),
+        power_of_ten(9 * 300) * 7 + 1,
+    };
+    // the powers 10^(9 2^k) the value is split by, and their neighbours
+    for (int k = 5; k <= 9; k++) {
+        big_integer p = power_of_ten(size_t(9) << k);
+        values.push_back(p);
+        values.push_back(p - 1);
+        values.push_back(-(p + 1));
+        values.push_back(p * p - 1);
+    }
+    for (big_integer const& x : values) {
+        std::ostringstream out;
+        mapped_integer m = mapped_integer::create(path, x);
+        ASSERT_GT(m.size(), 0u);
+        m.write_decimal(out);
+        EXPECT_EQ(to_string(x), out.str());
+    }
+    mapped_integer::set_window_limbs(mapped_integer::WINDOW_LIMBS);
+    std::remove(path.c_str());
+}
+
+TEST(correctness, memory_resource)
+{
+    std::mt19937 gen(53);
+    big_integer a = random_big_integer(gen, 50);
+    big_integer b = random_big_integer(gen, 20);
+    big_integer outside = a * b + a / b;
+
+    // with the default resource failing every request, everything below has
+    // to come from the arena
+    std::pmr::monotonic_buffer_resource arena(std::pmr::new_delete_resource());
+    std::pmr::memory_resource* old = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    {
+        big_integer_resource_scope scope(&arena);
+        EXPECT_EQ(&arena, big_integer_resource());
+        big_integer x = a;
+        EXPECT_EQ(&arena, x.resource());
+        big_integer y = x * b + x / b;
+        EXPECT_EQ(&arena, y.resource());
+        EXPECT_EQ(outside, y);
+        EXPECT_EQ(to_string(outside), to_string(y));
+        std::ostringstream out;
+        out << std::hex << y;
+        std::istringstream in(out.str());
+        big_integer z;
+        in >> std::hex >> z;
+        EXPECT_EQ(y, z);
+
+        // values from different resources swap their contents, not buffers
+        std::swap(outside, z);
+        EXPECT_EQ(&arena, z.resource());
+        EXPECT_NE(&arena, outside.resource());
+        EXPECT_EQ(y, outside);
+    }
+    std::pmr::set_default_resource(old);
+    EXPECT_EQ(old, big_integer_resource());
+}
+
+TEST(correctness, knuth_division)
+{
+    std::mt19937 gen(59);
+    for (size_t n = 1; n < 40; n += 3) {
+        for (size_t m = 1; m < 40; m += 4) {
+            big_integer a = random_big_integer(gen, n);
+            big_integer b = random_big_integer(gen, m);
+            if (b == 0) {
+                continue;
+            }
+            big_integer q = a / b;
+            big_integer r = a % b;
+            EXPECT_EQ(a, q * b + r);
+            EXPECT_TRUE(r.abs() < b.abs());
+            EXPECT_TRUE(r == 0 || (r < 0) == (a < 0));
+        }
+    }
+
+    // divisors whose top limbs make the quotient estimate overshoot
+    big_integer v = (big_integer(0x80000000u) << 64) + (big_integer(0xffffffffu) << 32) + 1;
+    big_integer u = (v << 96) - 1;
+    EXPECT_EQ(u, (u / v) * v + u % v);
+    EXPECT_EQ(v - 1, (v * v - 1) % v);
+    EXPECT_EQ(v - 1, (v * v - 1) / v);
+
+    big_integer x = random_big_integer(gen, 30);
+    x /= x;
+    EXPECT_EQ(1, x);
+    EXPECT_THROW(x / 0, std::domain_error);
+}
+
+TEST(correctness, scratch_pool)
+{
+    std::mt19937 gen(61);
+    big_integer a = random_big_integer(gen, 200);
+    big_integer b = random_big_integer(gen, 70);
+    big_integer expected = a * b / (b - 1);
+    set_scratch_limit(0);
+    EXPECT_EQ(expected, a * b / (b - 1));
+    set_scratch_limit(1 << 20);
+    EXPECT_EQ(expected, a * b / (b - 1));
+    EXPECT_EQ(expected, a * b / (b - 1));
+    trim_scratch();
+    EXPECT_EQ(to_string(expected), to_string(a * b / (b - 1)));
+}
+
+TEST(correctness, shared_limbs)
+{
+    std::mt19937 gen(67);
+    big_integer a = random_big_integer(gen, 50);
+    std::string const digits = to_string(a);
+    big_integer b = a;
+    big_integer c;
+    c = b;
+    b += 1;
+    c <<= 40;
+    EXPECT_EQ(digits, to_string(a));
+    EXPECT_EQ(a + 1, b);
+    EXPECT_EQ(a << 40, c);
+
+    // readers of a and writers of their own copies of it at the same time
+    std::vector<std::thread> threads;
+    std::vector<big_integer> results(8);
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.emplace_back([&a, &results, t] {
+            for (int i = 0; i < 100; i++) {
+                big_integer copy = a;
+                if (t % 2 == 0) {
+                    copy *= big_integer(int(t) + 2);
+                    copy /= big_integer(int(t) + 2);
+                }
+                results[t] = copy;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (big_integer const& result : results) {
+        EXPECT_EQ(a, result);
+    }
+    EXPECT_EQ(digits, to_string(a));
+}
+
+TEST(correctness, big_integer_array)
+{
+    std::mt19937 gen(71);
+    std::vector<big_integer> values;
+    big_integer_array array;
+    for (size_t i = 0; i < 300; i++) {
+        values.push_back(random_big_integer(gen, i % 7));
+        array.push_back(values.back());
+    }
+    array.push_back(array[5]);
+    values.push_back(values[5]);
+    ASSERT_EQ(values.size(), array.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(values[i], big_integer(array[i]));
+    }
+    EXPECT_EQ(values[3] < values[4] ? -1 : values[3] > values[4] ? 1 : 0,
+              array.compare(3, 4));
+
+    big_integer scalar = random_big_integer(gen, 2);
+    big_integer_array sums = array;
+    sums.add(scalar);
+    big_integer_array products = array;
+    products.mul(scalar);
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(values[i] + scalar, big_integer(sums[i]));
+        EXPECT_EQ(values[i] * scalar, big_integer(products[i]));
+    }
+    products.mul(-scalar);
+    products.mul(big_integer(0));
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_TRUE(products[i].is_zero());
+    }
+
+    std::sort(values.begin(), values.end());
+    array.sort();
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(values[i], big_integer(array[i]));
+    }
+    EXPECT_TRUE(array == array);
+    EXPECT_TRUE(array != sums);
+
+    // the size is checked before any limb is read
+    size_t limbs = array.limbs();
+    big_integer_view huge(array[0].digits, big_integer_array::MAX_LIMBS + size_t(1), false);
+    EXPECT_THROW(array.push_back(huge), std::length_error);
+    EXPECT_EQ(values.size(), array.size());
+    EXPECT_EQ(limbs, array.limbs());
+}
+
+TEST(correctness, primality)
+{
+    std::vector<bool> sieve(10000, true);
+    for (size_t i = 2; i < sieve.size(); i++) {
+        for (size_t j = i * i; j < sieve.size(); j += i) {
+            sieve[j] = false;
+        }
+    }
+    for (int i = -5; i < 10000; i++) {
+        EXPECT_EQ(i >= 2 && sieve[i], is_probable_prime(big_integer(i))) << i;
+    }
+
+    big_integer m127 = (big_integer(1) << 127) - 1;
+    big_integer m521 = (big_integer(1) << 521) - 1;
+    // 561 is a Carmichael number, the last one a strong pseudoprime to the
+    // bases below 41
+    big_integer carmichael = 561;
+    big_integer spsp("3317044064679887385961981");
+    EXPECT_TRUE(is_probable_prime(m127));
+    EXPECT_TRUE(is_probable_prime(m521));
+    EXPECT_FALSE(is_probable_prime((big_integer(1) << 128) - 1));
+    EXPECT_FALSE(is_probable_prime(m127 * m521));
+    EXPECT_FALSE(is_probable_prime(carmichael));
+    EXPECT_FALSE(is_probable_prime(spsp));
+    EXPECT_FALSE(is_probable_prime(big_integer(4093) * 4093));
+
+    EXPECT_EQ(2, next_prime(big_integer(-7)));
+    EXPECT_EQ(2, next_prime(big_integer(1)));
+    EXPECT_EQ(3, next_prime(big_integer(2)));
+    EXPECT_EQ(4099, next_prime(big_integer(4093)));
+    EXPECT_EQ((big_integer(1) << 64) + 13, next_prime(big_integer(1) << 64));
+    EXPECT_EQ(m127, next_prime(m127 - 2));
+    EXPECT_EQ(m521, next_prime(m521 - 1));
+
+    std::vector<big_integer> candidates;
+    for (int i = 0; i < 64; i++) {
+        candidates.push_back(m127 + 2 * i);
+    }
+    big_integer_array array;
+    for (big_integer const& c : candidates) {
+        array.push_back(c);
+    }
+    std::vector<bool> expected;
+    for (big_integer const& c : candidates) {
+        expected.push_back(is_probable_prime(c));
+    }
+    EXPECT_EQ(expected, is_probable_prime(candidates));
+    EXPECT_EQ(expected, is_probable_prime(array));
+}
+
+TEST(correctness, rns_integer)
+{
+    auto basis = std::make_shared<rns_basis const>(1000);
+    EXPECT_TRUE(basis->modulus() > (big_integer(1) << 1001));
+    for (size_t i = 0; i < basis->size(); i++) {
+        EXPECT_TRUE(basis->prime(i) < (1u << 31));
+    }
+
+    std::mt19937 gen(73);
+    for (int iter = 0; iter < 20; iter++) {
+        big_integer a = random_big_integer(gen, 10);
+        big_integer b = random_big_integer(gen, 10);
+        big_integer c = random_big_integer(gen, 9);
+        rns_integer x(basis, a);
+        rns_integer y(basis, b);
+        rns_integer z(basis, c);
+        EXPECT_EQ(a, x.value());
+        EXPECT_EQ(a + b, (x + y).value());
+        EXPECT_EQ(a - b, (x - y).value());
+        EXPECT_EQ(a * b - c, (x * y - z).value());
+        EXPECT_EQ(a * b * c, (x * y * z).value());
+        x *= x;
+        EXPECT_EQ(a * a, x.value());
+        EXPECT_TRUE(x == rns_integer(basis, a * a));
+        EXPECT_TRUE(x != y);
+    }
+    EXPECT_EQ(0, rns_integer(basis).value());
+    EXPECT_EQ(-1, rns_integer(basis, big_integer(-1)).value());
+
+    // products leaving the range wrap modulo M
+    big_integer m = basis->modulus();
+    EXPECT_EQ(1, rns_integer(basis, m + 1).value());
+
+    auto other = std::make_shared<rns_basis const>(64);
+    EXPECT_THROW(rns_integer(basis) + rns_integer(other),
+                 std::invalid_argument);
+}
+
+TEST(correctness, gcd)
+{
+    EXPECT_EQ(0, gcd(0, 0));
+    EXPECT_EQ(5, gcd(0, -5));
+    EXPECT_EQ(6, gcd(-12, 18));
+    std::mt19937 gen(79);
+    big_integer a = random_big_integer(gen, 20).abs() + 1;
+    big_integer b = random_big_integer(gen, 15).abs() + 1;
+    big_integer c = random_big_integer(gen, 10).abs() + 1;
+    big_integer g = gcd(a * c, b * c);
+    EXPECT_EQ(0, g % c);
+    EXPECT_EQ(1, gcd(a * c / g, b * c / g));
+}
+
+TEST(correctness, big_rational)
+{
+    big_rational half(1, 2);
+    big_rational third(-2, -6);
+    EXPECT_EQ("1/2", to_string(half));
+    EXPECT_EQ("1/3", to_string(third));
+    EXPECT_EQ("5/6", to_string(half + third));
+    EXPECT_EQ("1/6", to_string(half - third));
+    EXPECT_EQ("1/6", to_string(half * third));
+    EXPECT_EQ("3/2", to_string(half / third));
+    EXPECT_EQ("-1/2", to_string(-half));
+    EXPECT_EQ("1", to_string(big_rational(4, 4)));
+    EXPECT_THROW(big_rational(1, 0), std::domain_error);
+    EXPECT_THROW(half / big_rational(), std::domain_error);
+
+    EXPECT_TRUE(third < half);
+    EXPECT_TRUE(-half < third);
+    EXPECT_TRUE(big_rational(2, 4) == half);
+    EXPECT_FALSE(big_rational(2, 4).is_normalized());
+    EXPECT_EQ(0, compare(big_rational(-3, 9), -third));
+
+    // harmonic numbers stay unreduced between the lazy reductions, and
+    // comparisons do not reduce them
+    big_rational h;
+    big_rational expected;
+    for (int i = 1; i <= 300; i++) {
+        h += big_rational(1, i);
+        expected += big_rational(1, i);
+        expected.normalize();
+        EXPECT_TRUE(h == expected);
+    }
+    EXPECT_FALSE(h.is_normalized());
+    h.normalize();
+    EXPECT_EQ(expected.numerator(), h.numerator());
+    EXPECT_EQ(expected.denominator(), h.denominator());
+
+    big_rational x = h;
+    x *= x;
+    EXPECT_TRUE(x.is_normalized());
+    EXPECT_TRUE(x / h == h);
+    x += big_integer(3);
+    x *= big_integer(6);
+    x -= big_integer(18);
+    EXPECT_TRUE(x == h * h * big_rational(6));
+
+    std::ostringstream out;
+    out << big_rational(-10, 4);
+    EXPECT_EQ("-5/2", out.str());
+}
+
+TEST(correctness, decimal_integer)
+{
+    std::mt19937 gen(83);
+    for (int iter = 0; iter < 30; iter++) {
+        big_integer a = random_big_integer(gen, 1 + iter % 9);
+        big_integer b = random_big_integer(gen, 1 + iter % 5);
+        decimal_integer x(a);
+        decimal_integer y(to_string(b));
+        EXPECT_EQ(to_string(a), to_string(x));
+        EXPECT_EQ(b, y.value());
+        EXPECT_EQ(to_string(a + b), to_string(x + y));
+        EXPECT_EQ(to_string(a - b), to_string(x - y));
+        EXPECT_EQ(to_string(b - a), to_string(y - x));
+        EXPECT_EQ(to_string(a * b), to_string(x * y));
+        EXPECT_EQ(a < b, x < y);
+        EXPECT_EQ(a == b, x == y);
+        decimal_integer z = x;
+        z *= 999999999u;
+        EXPECT_EQ(to_string(a * 999999999u), to_string(z));
+        z -= z;
+        EXPECT_TRUE(z.is_zero());
+        EXPECT_EQ("0", to_string(z));
+    }
+
+    EXPECT_EQ("0", to_string(decimal_integer("-000")));
+    EXPECT_EQ("1000000000", to_string(decimal_integer("+0001000000000")));
+    EXPECT_EQ("-9223372036854775808",
+              to_string(decimal_integer(std::numeric_limits<int64_t>::min())));
+    EXPECT_EQ(decimal_integer(-5), -decimal_integer(5));
+    EXPECT_THROW(decimal_integer("12a"), std::invalid_argument);
+    EXPECT_THROW(decimal_integer("-"), std::invalid_argument);
+    EXPECT_THROW(decimal_integer(""), std::invalid_argument);
+
+    std::ostringstream out;
+    out << decimal_integer("-123456789123456789");
+    EXPECT_EQ("-123456789123456789", out.str());
+}
+
+TEST(correctness, unbalanced_mul)
+{
+    std::mt19937 gen(89);
+    size_t const shapes[][2] = {{31, 33}, {32, 32}, {33, 65}, {64, 127},
+                                {100, 2000}, {200, 201}, {40, 5003},
+                                {97, 1000}, {300, 1100}};
+    for (auto const& shape : shapes) {
+        big_integer a = random_big_integer(gen, shape[0]);
+        big_integer b = random_big_integer(gen, shape[1]);
+        big_integer c = random_big_integer(gen, shape[1] / 2 + 1);
+        if (a == 0 || b == 0) {
+            continue;
+        }
+        big_integer p = a * b;
+        EXPECT_EQ(a, p / b);
+        EXPECT_EQ(0, p % a);
+        EXPECT_EQ(p, b * a);
+        EXPECT_EQ(p + a * c, a * (b + c));
+        // all limbs set is where carries into the partial products go
+        big_integer ones = (big_integer(1) << int(32 * shape[1])) - 1;
+        big_integer onesa = (big_integer(1) << int(32 * shape[0])) - 1;
+        EXPECT_EQ((onesa << int(32 * shape[1])) - onesa, onesa * ones);
+    }
+}
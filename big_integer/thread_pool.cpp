@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace {
+thread_local bool worker_thread = false;
+}
+
+struct thread_pool::job {
+    job(std::function<void(size_t)> const& task, size_t count)
+        : task(task), count(count) {}
+
+    void work() {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if (++done == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return done == count; });
+    }
+
+    bool exhausted() const {
+        return next >= count;
+    }
+
+    std::function<void(size_t)> const& task;
+    size_t count;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+thread_pool::thread_pool(size_t workers) {
+    for (size_t i = 0; i < workers; i++) {
+        this->workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t thread_pool::size() const {
+    return workers.size() + 1;
+}
+
+void thread_pool::run(size_t count, std::function<void(size_t)> const& task) {
+    auto j = std::make_shared<job>(task, count);
+    bool shared = !workers.empty() && count > 1;
+    if (shared) {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(j);
+    }
+    if (shared) {
+        cv.notify_all();
+    }
+    j->work();
+    if (shared) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(jobs.begin(), jobs.end(), j);
+        if (it != jobs.end()) {
+            jobs.erase(it);
+        }
+    }
+    j->wait();
+    if (j->error) {
+        std::rethrow_exception(j->error);
+    }
+}
+
+bool thread_pool::in_worker() {
+    return worker_thread;
+}
+
+thread_pool& thread_pool::shared() {
+    static thread_pool pool(
+        std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1);
+    return pool;
+}
+
+void thread_pool::worker_loop() {
+    worker_thread = true;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (stopping) {
+            return;
+        }
+        std::shared_ptr<job> j = jobs.front();
+        if (j->exhausted()) {
+            jobs.pop_front();
+            continue;
+        }
+        lock.unlock();
+        j->work();
+        lock.lock();
+    }
+}
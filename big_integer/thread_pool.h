@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct thread_pool {
+    explicit thread_pool(size_t workers);
+    thread_pool(thread_pool const& other) = delete;
+    thread_pool& operator=(thread_pool const& other) = delete;
+    ~thread_pool();
+
+    // number of threads taking part in run(), including the caller
+    size_t size() const;
+
+    // calls task(0), ..., task(count - 1) on the workers and on the calling
+    // thread and returns once all of them have finished
+    void run(size_t count, std::function<void(size_t)> const& task);
+
+    static bool in_worker();
+    // process-wide pool with one thread per hardware thread
+    static thread_pool& shared();
+
+private:
+    struct job;
+    void worker_loop();
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<job>> jobs;
+    std::vector<std::thread> workers;
+    bool stopping{false};
+};